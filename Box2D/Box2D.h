@@ -34,11 +34,13 @@ For discussion please visit http://box2d.org/forum
 #include "Box2D/Common/b2Settings.h"
 #include "Box2D/Common/b2Draw.h"
 #include "Box2D/Common/b2Timer.h"
+#include "Box2D/Common/b2HandleTable.h"
 
 #include "Box2D/Collision/Shapes/b2CircleShape.h"
 #include "Box2D/Collision/Shapes/b2EdgeShape.h"
 #include "Box2D/Collision/Shapes/b2ChainShape.h"
 #include "Box2D/Collision/Shapes/b2PolygonShape.h"
+#include "Box2D/Collision/Shapes/b2SharedShape.h"
 
 #include "Box2D/Collision/b2BroadPhase.h"
 #include "Box2D/Collision/b2Distance.h"
@@ -47,6 +49,9 @@ For discussion please visit http://box2d.org/forum
 
 #include "Box2D/Dynamics/b2Body.h"
 #include "Box2D/Dynamics/b2Fixture.h"
+#include "Box2D/Dynamics/b2SensorManager.h"
+#include "Box2D/Dynamics/b2StaticGeometry.h"
+#include "Box2D/Dynamics/b2QuerySnapshot.h"
 #include "Box2D/Dynamics/b2WorldCallbacks.h"
 #include "Box2D/Dynamics/b2TimeStep.h"
 #include "Box2D/Dynamics/b2World.h"
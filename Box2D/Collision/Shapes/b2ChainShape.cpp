@@ -28,7 +28,7 @@ b2ChainShape::~b2ChainShape()
 
 void b2ChainShape::Clear()
 {
-	b2Free(m_vertices);
+	m_allocator.Free(m_vertices);
 	m_vertices = nullptr;
 	m_count = 0;
 }
@@ -51,7 +51,7 @@ void b2ChainShape::CreateLoop(const b2Vec2* vertices, int32 count)
 	}
 
 	m_count = count + 1;
-	m_vertices = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	m_vertices = (b2Vec2*)m_allocator.Allocate(m_count * sizeof(b2Vec2));
 	memcpy(m_vertices, vertices, count * sizeof(b2Vec2));
 	m_vertices[count] = m_vertices[0];
 	m_prevVertex = m_vertices[m_count - 2];
@@ -71,7 +71,7 @@ void b2ChainShape::CreateChain(const b2Vec2* vertices, int32 count)
 	}
 
 	m_count = count;
-	m_vertices = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	m_vertices = (b2Vec2*)m_allocator.Allocate(count * sizeof(b2Vec2));
 	memcpy(m_vertices, vertices, m_count * sizeof(b2Vec2));
 
 	m_hasPrevVertex = false;
@@ -97,6 +97,7 @@ b2Shape* b2ChainShape::Clone(b2BlockAllocator* allocator) const
 {
 	void* mem = allocator->Allocate(sizeof(b2ChainShape));
 	b2ChainShape* clone = new (mem) b2ChainShape;
+	clone->m_allocator = allocator->GetAllocator();
 	clone->CreateChain(m_vertices, m_count);
 	clone->m_prevVertex = m_prevVertex;
 	clone->m_nextVertex = m_nextVertex;
@@ -26,7 +26,8 @@ class b2EdgeShape;
 /// A chain shape is a free form sequence of line segments.
 /// The chain has two-sided collision, so you can use inside and outside collision.
 /// Therefore, you may use any winding order.
-/// Since there may be many vertices, they are allocated using b2Alloc.
+/// Since there may be many vertices, they are allocated using m_allocator, which
+/// uses b2Alloc unless it is set before the vertices are created.
 /// Connectivity information is used to create smooth collisions.
 /// WARNING: The chain will not collide properly if there are self-intersections.
 class b2ChainShape : public b2Shape
@@ -34,7 +35,7 @@ class b2ChainShape : public b2Shape
 public:
 	b2ChainShape();
 
-	/// The destructor frees the vertices using b2Free.
+	/// The destructor frees the vertices using m_allocator.
 	~b2ChainShape();
 
 	/// Clear all data.
@@ -58,7 +59,8 @@ public:
 	/// Don't call this for loops.
 	void SetNextVertex(const b2Vec2& nextVertex);
 
-	/// Implement b2Shape. Vertices are cloned using b2Alloc.
+	/// Implement b2Shape. Vertices are cloned using the callbacks of the block allocator,
+	/// so the clones in a world use the world's memory.
 	b2Shape* Clone(b2BlockAllocator* allocator) const override;
 
 	/// @see b2Shape::GetChildCount
@@ -90,6 +92,9 @@ public:
 
 	b2Vec2 m_prevVertex, m_nextVertex;
 	bool m_hasPrevVertex, m_hasNextVertex;
+
+	/// Allocates the vertices. Don't change this while there are vertices.
+	b2Allocator m_allocator;
 };
 
 inline b2ChainShape::b2ChainShape()
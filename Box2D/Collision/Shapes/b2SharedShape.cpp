@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Collision/Shapes/b2SharedShape.h"
+#include "Box2D/Collision/Shapes/b2CircleShape.h"
+#include "Box2D/Collision/Shapes/b2EdgeShape.h"
+#include "Box2D/Collision/Shapes/b2PolygonShape.h"
+#include "Box2D/Collision/Shapes/b2ChainShape.h"
+#include <new>
+
+b2SharedShape* b2SharedShape::Create(const b2Shape* shape)
+{
+	void* mem = b2Alloc(sizeof(b2SharedShape));
+	b2SharedShape* shared = new (mem) b2SharedShape;
+
+	// The shape lives on the heap, so it does not depend on a block allocator.
+	switch (shape->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			void* shapeMem = b2Alloc(sizeof(b2CircleShape));
+			shared->m_shape = new (shapeMem) b2CircleShape(*(const b2CircleShape*)shape);
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			void* shapeMem = b2Alloc(sizeof(b2EdgeShape));
+			shared->m_shape = new (shapeMem) b2EdgeShape(*(const b2EdgeShape*)shape);
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			void* shapeMem = b2Alloc(sizeof(b2PolygonShape));
+			shared->m_shape = new (shapeMem) b2PolygonShape(*(const b2PolygonShape*)shape);
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			// Chains own their vertices, so they are copied like b2ChainShape::Clone.
+			const b2ChainShape* chain = (const b2ChainShape*)shape;
+			void* shapeMem = b2Alloc(sizeof(b2ChainShape));
+			b2ChainShape* s = new (shapeMem) b2ChainShape;
+			s->CreateChain(chain->m_vertices, chain->m_count);
+			s->m_prevVertex = chain->m_prevVertex;
+			s->m_nextVertex = chain->m_nextVertex;
+			s->m_hasPrevVertex = chain->m_hasPrevVertex;
+			s->m_hasNextVertex = chain->m_hasNextVertex;
+			shared->m_shape = s;
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	// Mass is proportional to density, so fixtures scale this.
+	shared->m_shape->ComputeMass(&shared->m_massData, 1.0f);
+
+	return shared;
+}
+
+b2SharedShape::b2SharedShape()
+{
+	m_shape = nullptr;
+}
+
+b2SharedShape::~b2SharedShape()
+{
+	if (m_shape)
+	{
+		m_shape->~b2Shape();
+		b2Free(m_shape);
+	}
+}
+
+void b2SharedShape::Retain()
+{
+	m_refCount.Retain();
+}
+
+void b2SharedShape::Release()
+{
+	if (m_refCount.Release())
+	{
+		this->~b2SharedShape();
+		b2Free(this);
+	}
+}
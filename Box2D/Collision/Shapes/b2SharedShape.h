@@ -0,0 +1,76 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SHARED_SHAPE_H
+#define B2_SHARED_SHAPE_H
+
+#include "Box2D/Collision/Shapes/b2Shape.h"
+#include "Box2D/Common/b2RefCount.h"
+
+/// An immutable shape that many fixtures can reference instead of each holding a clone,
+/// see b2FixtureDef::sharedShape. The mass data is computed once. The shape is reference
+/// counted, each fixture holds a reference. Fixtures of worlds on different threads may
+/// share a shape.
+/// @warning do not modify the shape returned by b2Fixture::GetShape for such fixtures.
+class b2SharedShape
+{
+public:
+	/// Create a shared copy of a shape with a reference count of one.
+	static b2SharedShape* Create(const b2Shape* shape);
+
+	/// Add a reference, see b2RefCount.
+	void Retain();
+
+	/// Remove a reference. The shape is destroyed when the last reference is removed.
+	void Release();
+
+	/// Get the shape.
+	const b2Shape* GetShape() const;
+
+	/// Get the mass data for a density of one.
+	const b2MassData& GetMassData() const;
+
+	/// Get the current reference count.
+	int32 GetReferenceCount() const;
+
+private:
+
+	b2SharedShape();
+	~b2SharedShape();
+
+	b2Shape* m_shape;
+	b2MassData m_massData;
+	b2RefCount m_refCount;
+};
+
+inline const b2Shape* b2SharedShape::GetShape() const
+{
+	return m_shape;
+}
+
+inline const b2MassData& b2SharedShape::GetMassData() const
+{
+	return m_massData;
+}
+
+inline int32 b2SharedShape::GetReferenceCount() const
+{
+	return m_refCount.GetCount();
+}
+
+#endif
@@ -18,23 +18,103 @@
 
 #include "Box2D/Collision/b2BroadPhase.h"
 
-b2BroadPhase::b2BroadPhase()
+// Append a trigger event, growing the buffer as needed.
+static void b2PushTriggerEvent(b2TriggerEvent** events, int32* count, int32* capacity,
+							   const b2Allocator& allocator, const b2BroadPhase& broadPhase, const b2Pair& pair)
 {
+	if (*count == *capacity)
+	{
+		b2TriggerEvent* oldEvents = *events;
+		*capacity = *capacity > 0 ? 2 * *capacity : 16;
+		*events = (b2TriggerEvent*)allocator.Allocate(*capacity * sizeof(b2TriggerEvent));
+		if (oldEvents)
+		{
+			memcpy(*events, oldEvents, *count * sizeof(b2TriggerEvent));
+			allocator.Free(oldEvents);
+		}
+	}
+
+	b2TriggerEvent* event = *events + *count;
+	if (broadPhase.IsTrigger(pair.proxyIdA))
+	{
+		event->triggerId = pair.proxyIdA;
+		event->proxyId = pair.proxyIdB;
+	}
+	else
+	{
+		event->triggerId = pair.proxyIdB;
+		event->proxyId = pair.proxyIdA;
+	}
+	event->triggerUserData = broadPhase.GetUserData(event->triggerId);
+	event->userData = broadPhase.GetUserData(event->proxyId);
+	++(*count);
+}
+
+b2BroadPhase::b2BroadPhase(const b2Allocator* allocator)
+	: m_tree(allocator)
+{
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
+	m_staticTree = nullptr;
+	m_staticUserData = nullptr;
+
 	m_proxyCount = 0;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
-	m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	m_pairBuffer = (b2Pair*)m_allocator.Allocate(m_pairCapacity * sizeof(b2Pair));
 
 	m_moveCapacity = 16;
 	m_moveCount = 0;
-	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	m_moveBuffer = (int32*)m_allocator.Allocate(m_moveCapacity * sizeof(int32));
+
+	// The trigger buffers are allocated on first use.
+	m_triggerPairs = nullptr;
+	m_triggerPairCapacity = 0;
+	m_triggerPairCount = 0;
+
+	m_triggerBeginEvents = nullptr;
+	m_triggerBeginCapacity = 0;
+	m_triggerBeginCount = 0;
+
+	m_triggerEndEvents = nullptr;
+	m_triggerEndCapacity = 0;
+	m_triggerEndCount = 0;
+	m_triggerUpdateEndCount = 0;
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
-	b2Free(m_moveBuffer);
-	b2Free(m_pairBuffer);
+	m_allocator.Free(m_moveBuffer);
+	m_allocator.Free(m_pairBuffer);
+	m_allocator.Free(m_triggerPairs);
+	m_allocator.Free(m_triggerBeginEvents);
+	m_allocator.Free(m_triggerEndEvents);
+}
+
+void b2BroadPhase::Reserve(int32 proxyCount)
+{
+	m_tree.Reserve(2 * proxyCount);
+
+	if (proxyCount > m_moveCapacity)
+	{
+		int32* oldBuffer = m_moveBuffer;
+		m_moveCapacity = proxyCount;
+		m_moveBuffer = (int32*)m_allocator.Allocate(m_moveCapacity * sizeof(int32));
+		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
+		m_allocator.Free(oldBuffer);
+	}
+
+	// The pair buffer only holds pairs during UpdatePairs.
+	if (proxyCount > m_pairCapacity)
+	{
+		m_allocator.Free(m_pairBuffer);
+		m_pairCapacity = proxyCount;
+		m_pairBuffer = (b2Pair*)m_allocator.Allocate(m_pairCapacity * sizeof(b2Pair));
+	}
 }
 
 int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
@@ -45,8 +125,38 @@ int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+int32 b2BroadPhase::CreateTrigger(const b2AABB& aabb, void* userData)
+{
+	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	m_tree.SetTrigger(proxyId, true);
+	++m_proxyCount;
+	BufferMove(proxyId);
+	return proxyId;
+}
+
 void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
+	b2Assert(IsStaticProxy(proxyId) == false);
+
+	// Remove the trigger overlaps of this proxy, keeping the pairs sorted.
+	if (m_tree.GetTriggerPairCount(proxyId) > 0)
+	{
+		int32 count = 0;
+		for (int32 i = 0; i < m_triggerPairCount; ++i)
+		{
+			const b2Pair& pair = m_triggerPairs[i];
+			if (pair.proxyIdA != proxyId && pair.proxyIdB != proxyId)
+			{
+				m_triggerPairs[count++] = pair;
+			}
+			else
+			{
+				RemoveTriggerPair(pair, proxyId);
+			}
+		}
+		m_triggerPairCount = count;
+	}
+
 	UnBufferMove(proxyId);
 	--m_proxyCount;
 	m_tree.DestroyProxy(proxyId);
@@ -54,6 +164,7 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
+	b2Assert(IsStaticProxy(proxyId) == false);
 	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
 	if (buffer)
 	{
@@ -66,15 +177,48 @@ void b2BroadPhase::TouchProxy(int32 proxyId)
 	BufferMove(proxyId);
 }
 
+void b2BroadPhase::SetStaticTree(const b2DynamicTree* tree, void** userData)
+{
+	if (m_staticTree && tree != m_staticTree)
+	{
+		// Forget the old static proxies.
+		int32 count = 0;
+		for (int32 i = 0; i < m_triggerPairCount; ++i)
+		{
+			const b2Pair& pair = m_triggerPairs[i];
+			if (IsStaticProxy(pair.proxyIdB) == false)
+			{
+				m_triggerPairs[count++] = pair;
+			}
+			else
+			{
+				RemoveTriggerPair(pair, pair.proxyIdB);
+			}
+		}
+		m_triggerPairCount = count;
+
+		for (int32 i = 0; i < m_moveCount; ++i)
+		{
+			if (IsStaticProxy(m_moveBuffer[i]))
+			{
+				m_moveBuffer[i] = e_nullProxy;
+			}
+		}
+	}
+
+	m_staticTree = tree;
+	m_staticUserData = userData;
+}
+
 void b2BroadPhase::BufferMove(int32 proxyId)
 {
 	if (m_moveCount == m_moveCapacity)
 	{
 		int32* oldBuffer = m_moveBuffer;
 		m_moveCapacity *= 2;
-		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		m_moveBuffer = (int32*)m_allocator.Allocate(m_moveCapacity * sizeof(int32));
 		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
-		b2Free(oldBuffer);
+		m_allocator.Free(oldBuffer);
 	}
 
 	m_moveBuffer[m_moveCount] = proxyId;
@@ -101,14 +245,20 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 		return true;
 	}
 
+	// Triggers do not pair with each other.
+	if (IsTrigger(proxyId) && IsTrigger(m_queryProxyId))
+	{
+		return true;
+	}
+
 	// Grow the pair buffer as needed.
 	if (m_pairCount == m_pairCapacity)
 	{
 		b2Pair* oldBuffer = m_pairBuffer;
 		m_pairCapacity *= 2;
-		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+		m_pairBuffer = (b2Pair*)m_allocator.Allocate(m_pairCapacity * sizeof(b2Pair));
 		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
-		b2Free(oldBuffer);
+		m_allocator.Free(oldBuffer);
 	}
 
 	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
@@ -117,3 +267,130 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+// Remove the trigger pairs whose fat AABBs stopped overlapping, keeping the pairs sorted.
+void b2BroadPhase::UpdateTriggerPairs()
+{
+	int32 count = 0;
+	for (int32 i = 0; i < m_triggerPairCount; ++i)
+	{
+		const b2Pair& pair = m_triggerPairs[i];
+		if (TestOverlap(pair.proxyIdA, pair.proxyIdB))
+		{
+			m_triggerPairs[count++] = pair;
+		}
+		else
+		{
+			b2PushTriggerEvent(&m_triggerEndEvents, &m_triggerEndCount, &m_triggerEndCapacity, m_allocator, *this, pair);
+			CountTriggerPair(pair, -1);
+		}
+	}
+	m_triggerPairCount = count;
+}
+
+// Report the exit of a trigger pair whose proxy is removed. The proxy id is
+// cleared in the event because it may be reused before the event is read.
+void b2BroadPhase::RemoveTriggerPair(const b2Pair& pair, int32 proxyId)
+{
+	b2PushTriggerEvent(&m_triggerEndEvents, &m_triggerEndCount, &m_triggerEndCapacity, m_allocator, *this, pair);
+	b2TriggerEvent* event = m_triggerEndEvents + m_triggerEndCount - 1;
+	if (event->triggerId == proxyId)
+	{
+		event->triggerId = e_nullProxy;
+	}
+	else
+	{
+		event->proxyId = e_nullProxy;
+	}
+
+	CountTriggerPair(pair, -1);
+}
+
+void b2BroadPhase::ClearTriggerEvents()
+{
+	// Keep the exit events of the overlaps removed since the last update.
+	int32 removedCount = m_triggerEndCount - m_triggerUpdateEndCount;
+	if (removedCount > 0 && m_triggerUpdateEndCount > 0)
+	{
+		memmove(m_triggerEndEvents, m_triggerEndEvents + m_triggerUpdateEndCount, removedCount * sizeof(b2TriggerEvent));
+	}
+	m_triggerEndCount = removedCount;
+	m_triggerUpdateEndCount = 0;
+
+	m_triggerBeginCount = 0;
+}
+
+void b2BroadPhase::ReplaceTriggerUserData(void* userData, void* newUserData)
+{
+	for (int32 i = 0; i < m_triggerBeginCount; ++i)
+	{
+		b2TriggerEvent* event = m_triggerBeginEvents + i;
+		if (event->triggerUserData == userData)
+		{
+			event->triggerUserData = newUserData;
+		}
+
+		if (event->userData == userData)
+		{
+			event->userData = newUserData;
+		}
+	}
+
+	for (int32 i = 0; i < m_triggerEndCount; ++i)
+	{
+		b2TriggerEvent* event = m_triggerEndEvents + i;
+		if (event->triggerUserData == userData)
+		{
+			event->triggerUserData = newUserData;
+		}
+
+		if (event->userData == userData)
+		{
+			event->userData = newUserData;
+		}
+	}
+}
+
+// Count a trigger pair in its proxies. The static tree is shared and is not
+// written, its proxies cannot move or be destroyed.
+void b2BroadPhase::CountTriggerPair(const b2Pair& pair, int32 count)
+{
+	if (IsStaticProxy(pair.proxyIdA) == false)
+	{
+		m_tree.AddTriggerPairs(pair.proxyIdA, count);
+	}
+
+	if (IsStaticProxy(pair.proxyIdB) == false)
+	{
+		m_tree.AddTriggerPairs(pair.proxyIdB, count);
+	}
+}
+
+// Add a new trigger pair. The first sortedCount trigger pairs are sorted
+// and hold the overlaps that existed before this update.
+void b2BroadPhase::AddTriggerPair(const b2Pair& pair, int32 sortedCount)
+{
+	if (std::binary_search(m_triggerPairs, m_triggerPairs + sortedCount, pair, b2PairLessThan))
+	{
+		return;
+	}
+
+	// Grow the trigger pair buffer as needed.
+	if (m_triggerPairCount == m_triggerPairCapacity)
+	{
+		b2Pair* oldPairs = m_triggerPairs;
+		m_triggerPairCapacity = m_triggerPairCapacity > 0 ? 2 * m_triggerPairCapacity : 16;
+		m_triggerPairs = (b2Pair*)m_allocator.Allocate(m_triggerPairCapacity * sizeof(b2Pair));
+		if (oldPairs)
+		{
+			memcpy(m_triggerPairs, oldPairs, m_triggerPairCount * sizeof(b2Pair));
+			m_allocator.Free(oldPairs);
+		}
+	}
+
+	m_triggerPairs[m_triggerPairCount] = pair;
+	++m_triggerPairCount;
+	CountTriggerPair(pair, 1);
+
+	b2PushTriggerEvent(&m_triggerBeginEvents, &m_triggerBeginCount, &m_triggerBeginCapacity, m_allocator, *this, pair);
+}
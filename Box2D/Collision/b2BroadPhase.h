@@ -30,6 +30,18 @@ struct b2Pair
 	int32 proxyIdB;
 };
 
+/// A trigger event is reported when a proxy fat AABB begins or ends overlapping
+/// the AABB of a trigger proxy. The user data is captured when the event is reported.
+/// When an overlap ends because a proxy is destroyed, the id of that proxy is
+/// e_nullProxy, since it may be reused. Its user data is still reported.
+struct b2TriggerEvent
+{
+	int32 triggerId;
+	int32 proxyId;
+	void* triggerUserData;
+	void* userData;
+};
+
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
@@ -39,17 +51,29 @@ public:
 
 	enum
 	{
-		e_nullProxy = -1
+		e_nullProxy = -1,
+
+		// The proxies of the static tree have ids with this bit set.
+		e_staticProxy = 0x40000000
 	};
 
-	b2BroadPhase();
+	/// @param allocator the source of the tree and the buffers, nullptr to use b2Alloc.
+	b2BroadPhase(const b2Allocator* allocator = nullptr);
 	~b2BroadPhase();
 
 	/// Create a proxy with an initial AABB. Pairs are not reported until
 	/// UpdatePairs is called.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
-	/// Destroy a proxy. It is up to the client to remove any pairs.
+	/// Create an AABB-only trigger proxy. Triggers take part in UpdatePairs but their
+	/// pairs are never reported to the callback. Instead the broad-phase tracks the
+	/// fat AABB overlap and buffers enter/exit events. Triggers do not pair with other triggers.
+	/// Use DestroyProxy and MoveProxy to manage the trigger.
+	int32 CreateTrigger(const b2AABB& aabb, void* userData);
+
+	/// Destroy a proxy. It is up to the client to remove any pairs. Trigger
+	/// overlaps involving this proxy get an exit event, which is kept by the
+	/// next ClearTriggerEvents so it is reported with the next UpdatePairs.
 	void DestroyProxy(int32 proxyId);
 
 	/// Call MoveProxy as many times as you like, then when you are done
@@ -59,6 +83,17 @@ public:
 	/// Call to trigger a re-processing of it's pairs on the next call to UpdatePairs.
 	void TouchProxy(int32 proxyId);
 
+	/// Use a read-only tree of static proxies that may be shared with other broad-phases.
+	/// Moving proxies are paired with it in UpdatePairs and queries and ray casts visit it.
+	/// Its proxies are reported as the tree proxy id plus e_staticProxy. They cannot be
+	/// moved or destroyed, but they can be touched. The tree must not change while it is used.
+	/// @param tree the static tree, nullptr to remove it.
+	/// @param userData the user data of the static proxies, indexed by the tree proxy id.
+	void SetStaticTree(const b2DynamicTree* tree, void** userData);
+
+	/// Is this a proxy of the static tree?
+	static bool IsStaticProxy(int32 proxyId);
+
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
@@ -68,6 +103,26 @@ public:
 	/// Test overlap of fat AABBs.
 	bool TestOverlap(int32 proxyIdA, int32 proxyIdB) const;
 
+	/// Is this proxy a trigger?
+	bool IsTrigger(int32 proxyId) const;
+
+	/// Get the trigger enter events buffered by UpdatePairs since the last call to ClearTriggerEvents.
+	const b2TriggerEvent* GetTriggerBeginEvents() const;
+	int32 GetTriggerBeginEventCount() const;
+
+	/// Get the trigger exit events buffered by UpdatePairs since the last call to ClearTriggerEvents.
+	/// This includes the overlaps removed by DestroyProxy and SetStaticTree.
+	const b2TriggerEvent* GetTriggerEndEvents() const;
+	int32 GetTriggerEndEventCount() const;
+
+	/// Clear the buffered trigger events. The exit events of the overlaps removed
+	/// since the last UpdatePairs are kept.
+	void ClearTriggerEvents();
+
+	/// Replace the user data of the buffered trigger events, for example with nullptr
+	/// when the object it points to is destroyed.
+	void ReplaceTriggerUserData(void* userData, void* newUserData);
+
 	/// Get the number of proxies.
 	int32 GetProxyCount() const;
 
@@ -99,21 +154,44 @@ public:
 	/// Get the quality metric of the embedded tree.
 	float32 GetTreeQuality() const;
 
+	/// Reserve the tree nodes and the move and pair buffers for this many proxies.
+	void Reserve(int32 proxyCount);
+
+	/// Get the bytes of the node pool of the embedded tree.
+	int32 GetTreeByteCount() const;
+
+	/// Get the tree of the moving proxies. The static tree is not included.
+	const b2DynamicTree& GetTree() const;
+
+	/// Get the bytes of the move, pair and trigger buffers.
+	int32 GetBufferByteCount() const;
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
+	/// @warning the static tree cannot be shifted.
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
 private:
 
 	friend class b2DynamicTree;
+	template <typename T> friend struct b2BroadPhaseWrapper;
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
 	bool QueryCallback(int32 proxyId);
 
+	void UpdateTriggerPairs();
+	void AddTriggerPair(const b2Pair& pair, int32 sortedCount);
+	void CountTriggerPair(const b2Pair& pair, int32 count);
+	void RemoveTriggerPair(const b2Pair& pair, int32 proxyId);
+
 	b2DynamicTree m_tree;
+	b2Allocator m_allocator;
+
+	const b2DynamicTree* m_staticTree;
+	void** m_staticUserData;
 
 	int32 m_proxyCount;
 
@@ -126,6 +204,61 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+
+	// Overlapping trigger pairs, sorted with b2PairLessThan.
+	b2Pair* m_triggerPairs;
+	int32 m_triggerPairCapacity;
+	int32 m_triggerPairCount;
+
+	b2TriggerEvent* m_triggerBeginEvents;
+	int32 m_triggerBeginCapacity;
+	int32 m_triggerBeginCount;
+
+	b2TriggerEvent* m_triggerEndEvents;
+	int32 m_triggerEndCapacity;
+	int32 m_triggerEndCount;
+
+	// The exit events written by the last UpdatePairs. The events after these
+	// were added by removals and are carried over to the next update.
+	int32 m_triggerUpdateEndCount;
+};
+
+/// This is used internally to visit the tree and the static tree of a broad-phase with
+/// one callback. It tags the static proxy ids and carries termination and ray clipping
+/// over from one tree to the next.
+template <typename T>
+struct b2BroadPhaseWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		if (callback->QueryCallback(proxyId + offset) == false)
+		{
+			terminated = true;
+			return false;
+		}
+
+		return true;
+	}
+
+	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
+	{
+		float32 value = callback->RayCastCallback(input, proxyId + offset);
+		if (value == 0.0f)
+		{
+			terminated = true;
+		}
+		else if (value > 0.0f)
+		{
+			maxFraction = value;
+		}
+
+		return value;
+	}
+
+	T* callback;
+	int32 offset;
+	float32 maxFraction;
+	bool terminated;
 };
 
 /// This is used to sort pairs.
@@ -144,23 +277,68 @@ inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
 	return false;
 }
 
+inline bool b2BroadPhase::IsStaticProxy(int32 proxyId)
+{
+	return proxyId >= e_staticProxy;
+}
+
 inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
+	if (IsStaticProxy(proxyId))
+	{
+		return m_staticUserData[proxyId - e_staticProxy];
+	}
+
 	return m_tree.GetUserData(proxyId);
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
+	if (IsStaticProxy(proxyId))
+	{
+		return m_staticTree->GetFatAABB(proxyId - e_staticProxy);
+	}
+
 	return m_tree.GetFatAABB(proxyId);
 }
 
+inline bool b2BroadPhase::IsTrigger(int32 proxyId) const
+{
+	if (IsStaticProxy(proxyId))
+	{
+		return m_staticTree->IsTrigger(proxyId - e_staticProxy);
+	}
+
+	return m_tree.IsTrigger(proxyId);
+}
+
+inline const b2TriggerEvent* b2BroadPhase::GetTriggerBeginEvents() const
+{
+	return m_triggerBeginEvents;
+}
+
+inline int32 b2BroadPhase::GetTriggerBeginEventCount() const
+{
+	return m_triggerBeginCount;
+}
+
+inline const b2TriggerEvent* b2BroadPhase::GetTriggerEndEvents() const
+{
+	return m_triggerEndEvents;
+}
+
+inline int32 b2BroadPhase::GetTriggerEndEventCount() const
+{
+	return m_triggerEndCount;
+}
+
 inline int32 b2BroadPhase::GetProxyCount() const
 {
 	return m_proxyCount;
@@ -181,12 +359,46 @@ inline float32 b2BroadPhase::GetTreeQuality() const
 	return m_tree.GetAreaRatio();
 }
 
+inline int32 b2BroadPhase::GetTreeByteCount() const
+{
+	return m_tree.GetNodeCapacity() * sizeof(b2TreeNode);
+}
+
+inline const b2DynamicTree& b2BroadPhase::GetTree() const
+{
+	return m_tree;
+}
+
+inline int32 b2BroadPhase::GetBufferByteCount() const
+{
+	int32 count = m_moveCapacity * sizeof(int32);
+	count += m_pairCapacity * sizeof(b2Pair);
+	count += m_triggerPairCapacity * sizeof(b2Pair);
+	count += (m_triggerBeginCapacity + m_triggerEndCapacity) * sizeof(b2TriggerEvent);
+	return count;
+}
+
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
 	// Reset pair buffer
 	m_pairCount = 0;
 
+	// Trigger overlap can only end if a proxy of a trigger pair was moved.
+	if (m_triggerPairCount > 0)
+	{
+		for (int32 i = 0; i < m_moveCount; ++i)
+		{
+			int32 proxyId = m_moveBuffer[i];
+			if (proxyId != e_nullProxy && IsStaticProxy(proxyId) == false && m_tree.GetTriggerPairCount(proxyId) > 0)
+			{
+				UpdateTriggerPairs();
+				break;
+			}
+		}
+	}
+	int32 triggerPairCount = m_triggerPairCount;
+
 	// Perform tree queries for all moving proxies.
 	for (int32 i = 0; i < m_moveCount; ++i)
 	{
@@ -198,10 +410,19 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
 		// We have to query the tree with the fat AABB so that
 		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		const b2AABB& fatAABB = GetFatAABB(m_queryProxyId);
 
 		// Query tree, create pairs and add them pair buffer.
 		m_tree.Query(this, fatAABB);
+
+		// Static proxies do not pair with each other.
+		if (m_staticTree && IsStaticProxy(m_queryProxyId) == false)
+		{
+			b2BroadPhaseWrapper<b2BroadPhase> wrapper;
+			wrapper.callback = this;
+			wrapper.offset = e_staticProxy;
+			m_staticTree->Query(&wrapper, fatAABB);
+		}
 	}
 
 	// Reset move buffer
@@ -215,10 +436,18 @@ void b2BroadPhase::UpdatePairs(T* callback)
 	while (i < m_pairCount)
 	{
 		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		if (IsTrigger(primaryPair->proxyIdA) || IsTrigger(primaryPair->proxyIdB))
+		{
+			// Trigger pairs stay in the broad-phase.
+			AddTriggerPair(*primaryPair, triggerPairCount);
+		}
+		else
+		{
+			void* userDataA = GetUserData(primaryPair->proxyIdA);
+			void* userDataB = GetUserData(primaryPair->proxyIdB);
 
-		callback->AddPair(userDataA, userDataB);
+			callback->AddPair(userDataA, userDataB);
+		}
 		++i;
 
 		// Skip any duplicate pairs.
@@ -233,6 +462,14 @@ void b2BroadPhase::UpdatePairs(T* callback)
 		}
 	}
 
+	// Keep the trigger pairs sorted for the next update.
+	if (m_triggerPairCount > triggerPairCount)
+	{
+		std::sort(m_triggerPairs, m_triggerPairs + m_triggerPairCount, b2PairLessThan);
+	}
+
+	m_triggerUpdateEndCount = m_triggerEndCount;
+
 	// Try to keep the tree balanced.
 	//m_tree.Rebalance(4);
 }
@@ -240,17 +477,54 @@ void b2BroadPhase::UpdatePairs(T* callback)
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	if (m_staticTree == nullptr)
+	{
+		m_tree.Query(callback, aabb);
+		return;
+	}
+
+	b2BroadPhaseWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.offset = 0;
+	wrapper.terminated = false;
+	m_tree.Query(&wrapper, aabb);
+
+	if (wrapper.terminated == false)
+	{
+		wrapper.offset = e_staticProxy;
+		m_staticTree->Query(&wrapper, aabb);
+	}
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	if (m_staticTree == nullptr)
+	{
+		m_tree.RayCast(callback, input);
+		return;
+	}
+
+	b2BroadPhaseWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.offset = 0;
+	wrapper.maxFraction = input.maxFraction;
+	wrapper.terminated = false;
+	m_tree.RayCast(&wrapper, input);
+
+	if (wrapper.terminated == false)
+	{
+		// The static tree continues with the ray clipped by the first tree.
+		b2RayCastInput subInput = input;
+		subInput.maxFraction = wrapper.maxFraction;
+		wrapper.offset = e_staticProxy;
+		m_staticTree->RayCast(&wrapper, subInput);
+	}
 }
 
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
+	b2Assert(m_staticTree == nullptr);
 	m_tree.ShiftOrigin(newOrigin);
 }
 
@@ -98,6 +98,10 @@ inline int32 b2DistanceProxy::GetVertexCount() const
 	return m_count;
 }
 
+/// GJK statistics. These are per thread so that worlds can be stepped
+/// on separate threads. b2World::Step reports them in b2Profile.
+extern thread_local int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+
 inline const b2Vec2& b2DistanceProxy::GetVertex(int32 index) const
 {
 	b2Assert(0 <= index && index < m_count);
@@ -19,13 +19,18 @@
 #include "Box2D/Collision/b2DynamicTree.h"
 #include <string.h>
 
-b2DynamicTree::b2DynamicTree()
+b2DynamicTree::b2DynamicTree(const b2Allocator* allocator)
 {
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
 	m_root = b2_nullNode;
 
 	m_nodeCapacity = 16;
 	m_nodeCount = 0;
-	m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	m_nodes = (b2TreeNode*)m_allocator.Allocate(m_nodeCapacity * sizeof(b2TreeNode));
 	memset(m_nodes, 0, m_nodeCapacity * sizeof(b2TreeNode));
 
 	// Build a linked list for the free list.
@@ -46,7 +51,63 @@ b2DynamicTree::b2DynamicTree()
 b2DynamicTree::~b2DynamicTree()
 {
 	// This frees the entire tree in one shot.
-	b2Free(m_nodes);
+	m_allocator.Free(m_nodes);
+}
+
+void b2DynamicTree::CopyFrom(const b2DynamicTree* tree)
+{
+	if (m_nodeCapacity < tree->m_nodeCapacity)
+	{
+		m_allocator.Free(m_nodes);
+		m_nodeCapacity = tree->m_nodeCapacity;
+		m_nodes = (b2TreeNode*)m_allocator.Allocate(m_nodeCapacity * sizeof(b2TreeNode));
+	}
+
+	memcpy(m_nodes, tree->m_nodes, tree->m_nodeCapacity * sizeof(b2TreeNode));
+	m_root = tree->m_root;
+	m_nodeCount = tree->m_nodeCount;
+	m_freeList = tree->m_freeList;
+	m_path = tree->m_path;
+	m_insertionCount = tree->m_insertionCount;
+
+	// Put the extra nodes of a larger pool in front of the free list.
+	if (tree->m_nodeCapacity < m_nodeCapacity)
+	{
+		for (int32 i = tree->m_nodeCapacity; i < m_nodeCapacity - 1; ++i)
+		{
+			m_nodes[i].next = i + 1;
+			m_nodes[i].height = -1;
+		}
+		m_nodes[m_nodeCapacity - 1].next = m_freeList;
+		m_nodes[m_nodeCapacity - 1].height = -1;
+		m_freeList = tree->m_nodeCapacity;
+	}
+}
+
+void b2DynamicTree::Reserve(int32 nodeCount)
+{
+	if (nodeCount <= m_nodeCapacity)
+	{
+		return;
+	}
+
+	b2TreeNode* oldNodes = m_nodes;
+	int32 oldCapacity = m_nodeCapacity;
+	m_nodeCapacity = nodeCount;
+	m_nodes = (b2TreeNode*)m_allocator.Allocate(m_nodeCapacity * sizeof(b2TreeNode));
+	memcpy(m_nodes, oldNodes, oldCapacity * sizeof(b2TreeNode));
+	m_allocator.Free(oldNodes);
+
+	// Put the new nodes in front of the free list. Free nodes only use next and
+	// height, AllocateNode sets the other fields.
+	for (int32 i = oldCapacity; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity - 1].next = m_freeList;
+	m_nodes[m_nodeCapacity - 1].height = -1;
+	m_freeList = oldCapacity;
 }
 
 // Allocate a node from the pool. Grow the pool if necessary.
@@ -60,9 +121,9 @@ int32 b2DynamicTree::AllocateNode()
 		// The free list is empty. Rebuild a bigger pool.
 		b2TreeNode* oldNodes = m_nodes;
 		m_nodeCapacity *= 2;
-		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+		m_nodes = (b2TreeNode*)m_allocator.Allocate(m_nodeCapacity * sizeof(b2TreeNode));
 		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(b2TreeNode));
-		b2Free(oldNodes);
+		m_allocator.Free(oldNodes);
 
 		// Build a linked list for the free list. The parent
 		// pointer becomes the "next" pointer.
@@ -111,6 +172,7 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	m_nodes[proxyId].aabb.lowerBound = aabb.lowerBound - r;
 	m_nodes[proxyId].aabb.upperBound = aabb.upperBound + r;
 	m_nodes[proxyId].userData = userData;
+	m_nodes[proxyId].leafFlags = 0;
 	m_nodes[proxyId].height = 0;
 
 	InsertLeaf(proxyId);
@@ -595,8 +657,8 @@ void b2DynamicTree::ValidateStructure(int32 index) const
 
 	if (node->IsLeaf())
 	{
+		// The second child of a leaf holds its flags.
 		b2Assert(child1 == b2_nullNode);
-		b2Assert(child2 == b2_nullNode);
 		b2Assert(node->height == 0);
 		return;
 	}
@@ -625,8 +687,8 @@ void b2DynamicTree::ValidateMetrics(int32 index) const
 
 	if (node->IsLeaf())
 	{
+		// The second child of a leaf holds its flags.
 		b2Assert(child1 == b2_nullNode);
-		b2Assert(child2 == b2_nullNode);
 		b2Assert(node->height == 0);
 		return;
 	}
@@ -695,7 +757,7 @@ int32 b2DynamicTree::GetMaxBalance() const
 
 void b2DynamicTree::RebuildBottomUp()
 {
-	int32* nodes = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32* nodes = (int32*)m_allocator.Allocate(m_nodeCount * sizeof(int32));
 	int32 count = 0;
 
 	// Build array of leaves. Free the rest.
@@ -764,7 +826,7 @@ void b2DynamicTree::RebuildBottomUp()
 	}
 
 	m_root = nodes[0];
-	b2Free(nodes);
+	m_allocator.Free(nodes);
 
 	Validate();
 }
@@ -44,7 +44,13 @@ struct b2TreeNode
 	};
 
 	int32 child1;
-	int32 child2;
+
+	// A leaf has no second child, so it keeps its proxy flags here.
+	union
+	{
+		int32 child2;
+		int32 leafFlags;
+	};
 
 	// leaf = 0, free node = -1
 	int32 height;
@@ -62,7 +68,8 @@ class b2DynamicTree
 {
 public:
 	/// Constructing the tree initializes the node pool.
-	b2DynamicTree();
+	/// @param allocator the source of the node pool, nullptr to use b2Alloc.
+	b2DynamicTree(const b2Allocator* allocator = nullptr);
 
 	/// Destroy the tree, freeing the node pool.
 	~b2DynamicTree();
@@ -86,6 +93,19 @@ public:
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
+	/// Flag a proxy as an AABB-only trigger.
+	void SetTrigger(int32 proxyId, bool flag);
+
+	/// Is this proxy an AABB-only trigger?
+	bool IsTrigger(int32 proxyId) const;
+
+	/// Add to the number of trigger pairs of a proxy. The broad-phase uses this to skip
+	/// the trigger pairs when no proxy involved in them changed.
+	void AddTriggerPairs(int32 proxyId, int32 count);
+
+	/// Get the number of trigger pairs of a proxy.
+	int32 GetTriggerPairCount(int32 proxyId) const;
+
 	/// Query an AABB for overlapping proxies. The callback class
 	/// is called for each proxy that overlaps the supplied AABB.
 	template <typename T>
@@ -115,6 +135,17 @@ public:
 	/// Get the ratio of the sum of the node areas to the root area.
 	float32 GetAreaRatio() const;
 
+	/// Get the number of nodes in the node pool.
+	int32 GetNodeCapacity() const;
+
+	/// Grow the node pool to hold at least this many nodes. A tree
+	/// of n proxies has 2n - 1 nodes.
+	void Reserve(int32 nodeCount);
+
+	/// Make this tree a copy of another tree. Proxy ids are preserved. The node
+	/// pool is reused when it is large enough.
+	void CopyFrom(const b2DynamicTree* tree);
+
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
@@ -125,6 +156,13 @@ public:
 
 private:
 
+	// The leaf flags hold the trigger bit and the trigger pair count.
+	enum
+	{
+		e_triggerLeaf = 0x40000000,
+		e_triggerPairMask = e_triggerLeaf - 1
+	};
+
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
@@ -139,6 +177,8 @@ private:
 	void ValidateStructure(int32 index) const;
 	void ValidateMetrics(int32 index) const;
 
+	b2Allocator m_allocator;
+
 	int32 m_root;
 
 	b2TreeNode* m_nodes;
@@ -153,6 +193,11 @@ private:
 	int32 m_insertionCount;
 };
 
+inline int32 b2DynamicTree::GetNodeCapacity() const
+{
+	return m_nodeCapacity;
+}
+
 inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -165,6 +210,40 @@ inline const b2AABB& b2DynamicTree::GetFatAABB(int32 proxyId) const
 	return m_nodes[proxyId].aabb;
 }
 
+inline void b2DynamicTree::SetTrigger(int32 proxyId, bool flag)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	b2Assert(m_nodes[proxyId].IsLeaf());
+	if (flag)
+	{
+		m_nodes[proxyId].leafFlags |= e_triggerLeaf;
+	}
+	else
+	{
+		m_nodes[proxyId].leafFlags &= ~e_triggerLeaf;
+	}
+}
+
+inline bool b2DynamicTree::IsTrigger(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	return (m_nodes[proxyId].leafFlags & e_triggerLeaf) != 0;
+}
+
+inline void b2DynamicTree::AddTriggerPairs(int32 proxyId, int32 count)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	b2Assert(m_nodes[proxyId].IsLeaf());
+	b2Assert(GetTriggerPairCount(proxyId) + count >= 0);
+	m_nodes[proxyId].leafFlags += count;
+}
+
+inline int32 b2DynamicTree::GetTriggerPairCount(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	return m_nodes[proxyId].leafFlags & e_triggerPairMask;
+}
+
 template <typename T>
 inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 {
@@ -38,13 +38,47 @@ int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] =
 	512,	// 12
 	640,	// 13
 };
-uint8 b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
-bool b2BlockAllocator::s_blockSizeLookupInitialized;
 
+// The size class of each size.
+struct b2SizeMap
+{
+	b2SizeMap()
+	{
+		int32 j = 0;
+		values[0] = 0;
+		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
+		{
+			b2Assert(j < b2_blockSizes);
+			if (i <= b2BlockAllocator::s_blockSizes[j])
+			{
+				values[i] = (uint8)j;
+			}
+			else
+			{
+				++j;
+				values[i] = (uint8)j;
+			}
+		}
+	}
+
+	uint8 values[b2_maxBlockSize + 1];
+};
+
+// The map is built on first use, so allocators created during the static
+// initialization of other translation units see a complete map. The
+// initialization of a local static is thread-safe.
+static const b2SizeMap& b2GetSizeMap()
+{
+	static const b2SizeMap sizeMap;
+	return sizeMap;
+}
+
+// The chunk header is followed by the chunk size in bytes of blocks.
 struct b2Chunk
 {
-	int32 blockSize;
+	b2Chunk* next;
 	b2Block* blocks;
+	int32 blockSize;
 };
 
 struct b2Block
@@ -52,46 +86,98 @@ struct b2Block
 	b2Block* next;
 };
 
-b2BlockAllocator::b2BlockAllocator()
+b2BlockAllocator::b2BlockAllocator(const b2Allocator* allocator, int32 chunkSize)
 {
 	b2Assert(b2_blockSizes < UCHAR_MAX);
+	b2Assert(chunkSize >= b2_maxBlockSize);
 
-	m_chunkSpace = b2_chunkArrayIncrement;
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
+	m_root = this;
+	m_chunkSize = chunkSize;
+	m_chunkList = nullptr;
 	m_chunkCount = 0;
-	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
-	
-	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
-	memset(m_freeLists, 0, sizeof(m_freeLists));
 
-	if (s_blockSizeLookupInitialized == false)
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	for (int32 i = 0; i < b2_blockSizes; ++i)
 	{
-		int32 j = 0;
-		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
-		{
-			b2Assert(j < b2_blockSizes);
-			if (i <= s_blockSizes[j])
-			{
-				s_blockSizeLookup[i] = (uint8)j;
-			}
-			else
-			{
-				++j;
-				s_blockSizeLookup[i] = (uint8)j;
-			}
-		}
+		m_sharedLists[i] = nullptr;
+	}
+}
+
+b2BlockAllocator::b2BlockAllocator(b2BlockAllocator* root)
+{
+	b2Assert(root != nullptr && root->m_root == root);
+
+	m_allocator = root->m_allocator;
+	m_root = root;
+	m_chunkSize = root->m_chunkSize;
+	m_chunkList = nullptr;
+	m_chunkCount = 0;
 
-		s_blockSizeLookupInitialized = true;
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		m_sharedLists[i] = nullptr;
 	}
 }
 
 b2BlockAllocator::~b2BlockAllocator()
 {
-	for (int32 i = 0; i < m_chunkCount; ++i)
+	if (m_root != this)
+	{
+		Flush();
+		return;
+	}
+
+	// The caches of other threads must be destroyed before the root.
+	b2Chunk* chunk = m_chunkList.load(std::memory_order_acquire);
+	while (chunk)
+	{
+		b2Chunk* next = chunk->next;
+		m_allocator.Free(chunk);
+		chunk = next;
+	}
+}
+
+// Carve a new chunk into blocks and return the block list. This may
+// be called by the caches of several threads at the same time.
+b2Block* b2BlockAllocator::AllocateChunk(int32 index)
+{
+	b2Assert(m_root == this);
+
+	b2Chunk* chunk = (b2Chunk*)m_allocator.Allocate(sizeof(b2Chunk) + m_chunkSize);
+	chunk->blocks = (b2Block*)(chunk + 1);
+#if defined(_DEBUG)
+	memset(chunk->blocks, 0xcd, m_chunkSize);
+#endif
+	int32 blockSize = s_blockSizes[index];
+	chunk->blockSize = blockSize;
+	int32 blockCount = m_chunkSize / blockSize;
+	b2Assert(blockCount * blockSize <= m_chunkSize);
+	for (int32 i = 0; i < blockCount - 1; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
+		b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
+		block->next = next;
 	}
+	b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
+	last->next = nullptr;
 
-	b2Free(m_chunks);
+	// Publish the chunk so that the root can free it.
+	b2Chunk* head = m_chunkList.load(std::memory_order_relaxed);
+	do
+	{
+		chunk->next = head;
+	}
+	while (m_chunkList.compare_exchange_weak(head, chunk, std::memory_order_release, std::memory_order_relaxed) == false);
+
+	m_chunkCount.fetch_add(1, std::memory_order_relaxed);
+
+	return chunk->blocks;
 }
 
 void* b2BlockAllocator::Allocate(int32 size)
@@ -103,53 +189,30 @@ void* b2BlockAllocator::Allocate(int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		return b2Alloc(size);
+		return m_allocator.Allocate(size);
 	}
 
-	int32 index = s_blockSizeLookup[size];
+	int32 index = b2GetSizeMap().values[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
-	if (m_freeLists[index])
+	b2Block* block = m_freeLists[index];
+	if (block == nullptr)
 	{
-		b2Block* block = m_freeLists[index];
-		m_freeLists[index] = block->next;
-		return block;
-	}
-	else
-	{
-		if (m_chunkCount == m_chunkSpace)
+		// Take the blocks that other threads gave back, else make a new chunk.
+		std::atomic<b2Block*>& shared = m_root->m_sharedLists[index];
+		if (shared.load(std::memory_order_relaxed) != nullptr)
 		{
-			b2Chunk* oldChunks = m_chunks;
-			m_chunkSpace += b2_chunkArrayIncrement;
-			m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
-			memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
-			memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-			b2Free(oldChunks);
+			block = shared.exchange(nullptr, std::memory_order_acquire);
 		}
 
-		b2Chunk* chunk = m_chunks + m_chunkCount;
-		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
-#if defined(_DEBUG)
-		memset(chunk->blocks, 0xcd, b2_chunkSize);
-#endif
-		int32 blockSize = s_blockSizes[index];
-		chunk->blockSize = blockSize;
-		int32 blockCount = b2_chunkSize / blockSize;
-		b2Assert(blockCount * blockSize <= b2_chunkSize);
-		for (int32 i = 0; i < blockCount - 1; ++i)
+		if (block == nullptr)
 		{
-			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
-			b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
-			block->next = next;
+			block = m_root->AllocateChunk(index);
 		}
-		b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
-		last->next = nullptr;
-
-		m_freeLists[index] = chunk->blocks->next;
-		++m_chunkCount;
-
-		return chunk->blocks;
 	}
+
+	m_freeLists[index] = block->next;
+	return block;
 }
 
 void b2BlockAllocator::Free(void* p, int32 size)
@@ -163,28 +226,27 @@ void b2BlockAllocator::Free(void* p, int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		b2Free(p);
+		m_allocator.Free(p);
 		return;
 	}
 
-	int32 index = s_blockSizeLookup[size];
+	int32 index = b2GetSizeMap().values[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
 #ifdef _DEBUG
 	// Verify the memory address and size is valid.
 	int32 blockSize = s_blockSizes[index];
 	bool found = false;
-	for (int32 i = 0; i < m_chunkCount; ++i)
+	for (b2Chunk* chunk = m_root->m_chunkList.load(std::memory_order_acquire); chunk; chunk = chunk->next)
 	{
-		b2Chunk* chunk = m_chunks + i;
 		if (chunk->blockSize != blockSize)
 		{
 			b2Assert(	(int8*)p + blockSize <= (int8*)chunk->blocks ||
-						(int8*)chunk->blocks + b2_chunkSize <= (int8*)p);
+						(int8*)chunk->blocks + m_chunkSize <= (int8*)p);
 		}
 		else
 		{
-			if ((int8*)chunk->blocks <= (int8*)p && (int8*)p + blockSize <= (int8*)chunk->blocks + b2_chunkSize)
+			if ((int8*)chunk->blocks <= (int8*)p && (int8*)p + blockSize <= (int8*)chunk->blocks + m_chunkSize)
 			{
 				found = true;
 			}
@@ -201,15 +263,228 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	m_freeLists[index] = block;
 }
 
+void b2BlockAllocator::Reserve(int32 size, int32 count)
+{
+	if (size <= 0 || size > b2_maxBlockSize || count <= 0)
+	{
+		return;
+	}
+
+	int32 index = b2GetSizeMap().values[size];
+	b2Assert(0 <= index && index < b2_blockSizes);
+
+	int32 freeCount = 0;
+	for (b2Block* block = m_freeLists[index]; block && freeCount < count; block = block->next)
+	{
+		++freeCount;
+	}
+
+	int32 blockCount = m_chunkSize / s_blockSizes[index];
+	while (freeCount < count)
+	{
+		// Put the blocks of a new chunk in front of the free list.
+		b2Block* list = m_root->AllocateChunk(index);
+		b2Block* last = (b2Block*)((int8*)list + s_blockSizes[index] * (blockCount - 1));
+		last->next = m_freeLists[index];
+		m_freeLists[index] = list;
+		freeCount += blockCount;
+	}
+}
+
+void b2BlockAllocator::Flush()
+{
+	if (m_root == this)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		b2Block* list = m_freeLists[i];
+		if (list == nullptr)
+		{
+			continue;
+		}
+
+		b2Block* tail = list;
+		while (tail->next)
+		{
+			tail = tail->next;
+		}
+
+		// Push the whole list. The lists are only popped as a whole, so there is no ABA problem.
+		std::atomic<b2Block*>& shared = m_root->m_sharedLists[i];
+		b2Block* head = shared.load(std::memory_order_relaxed);
+		do
+		{
+			tail->next = head;
+		}
+		while (shared.compare_exchange_weak(head, list, std::memory_order_release, std::memory_order_relaxed) == false);
+
+		m_freeLists[i] = nullptr;
+	}
+}
+
+int32 b2BlockAllocator::GetChunkCount() const
+{
+	return m_chunkCount.load(std::memory_order_relaxed);
+}
+
+int32 b2BlockAllocator::GetChunkSize() const
+{
+	return m_chunkSize;
+}
+
+const b2Allocator& b2BlockAllocator::GetAllocator() const
+{
+	return m_allocator;
+}
+
+int32 b2BlockAllocator::GetFreeByteCount() const
+{
+	int32 count = 0;
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		int32 blockCount = 0;
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			++blockCount;
+		}
+
+		for (b2Block* block = m_sharedLists[i].load(std::memory_order_acquire); block; block = block->next)
+		{
+			++blockCount;
+		}
+
+		count += blockCount * s_blockSizes[i];
+	}
+
+	return count;
+}
+
+int32 b2BlockAllocator::GetSlackByteCount() const
+{
+	int32 count = 0;
+	for (b2Chunk* chunk = m_chunkList.load(std::memory_order_acquire); chunk; chunk = chunk->next)
+	{
+		count += m_chunkSize % chunk->blockSize;
+	}
+
+	return count;
+}
+
+int32 b2BlockAllocator::GetBlockSize(int32 size)
+{
+	if (size <= 0)
+	{
+		return 0;
+	}
+
+	if (size > b2_maxBlockSize)
+	{
+		return size;
+	}
+
+	return s_blockSizes[b2GetSizeMap().values[size]];
+}
+
+void b2BlockAllocator::SortFreeList(int32 size)
+{
+	if (size <= 0 || size > b2_maxBlockSize)
+	{
+		return;
+	}
+
+	int32 index = b2GetSizeMap().values[size];
+	b2Assert(0 <= index && index < b2_blockSizes);
+
+	// Bottom-up merge sort of the singly linked free list.
+	b2Block* list = m_freeLists[index];
+	if (list == nullptr)
+	{
+		return;
+	}
+
+	for (int32 width = 1; ; width *= 2)
+	{
+		b2Block* p = list;
+		list = nullptr;
+		b2Block** tail = &list;
+		int32 mergeCount = 0;
+
+		while (p)
+		{
+			++mergeCount;
+
+			// Step over the first run to find the second run.
+			b2Block* q = p;
+			int32 pCount = 0;
+			for (int32 i = 0; i < width && q; ++i)
+			{
+				++pCount;
+				q = q->next;
+			}
+			int32 qCount = width;
+
+			// Merge the two runs.
+			while (pCount > 0 || (qCount > 0 && q))
+			{
+				b2Block* block;
+				if (pCount == 0)
+				{
+					block = q;
+					q = q->next;
+					--qCount;
+				}
+				else if (qCount == 0 || q == nullptr || (int8*)p < (int8*)q)
+				{
+					block = p;
+					p = p->next;
+					--pCount;
+				}
+				else
+				{
+					block = q;
+					q = q->next;
+					--qCount;
+				}
+
+				*tail = block;
+				tail = &block->next;
+			}
+
+			p = q;
+		}
+
+		*tail = nullptr;
+
+		if (mergeCount <= 1)
+		{
+			break;
+		}
+	}
+
+	m_freeLists[index] = list;
+}
+
 void b2BlockAllocator::Clear()
 {
-	for (int32 i = 0; i < m_chunkCount; ++i)
+	b2Assert(m_root == this);
+
+	b2Chunk* chunk = m_chunkList.load(std::memory_order_acquire);
+	while (chunk)
 	{
-		b2Free(m_chunks[i].blocks);
+		b2Chunk* next = chunk->next;
+		m_allocator.Free(chunk);
+		chunk = next;
 	}
 
+	m_chunkList = nullptr;
 	m_chunkCount = 0;
-	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		m_sharedLists[i] = nullptr;
+	}
 }
@@ -20,6 +20,7 @@
 #define B2_BLOCK_ALLOCATOR_H
 
 #include "Box2D/Common/b2Settings.h"
+#include <atomic>
 
 const int32 b2_chunkSize = 16 * 1024;
 const int32 b2_maxBlockSize = 640;
@@ -32,31 +33,87 @@ struct b2Chunk;
 /// This is a small object allocator used for allocating small
 /// objects that persist for more than one time step.
 /// See: http://www.codeproject.com/useritems/Small_Block_Allocator.asp
+///
+/// An allocator is used by one thread. Other threads use a cache, which is
+/// an allocator constructed from the root allocator. Caches take new chunks
+/// from the root without locks and a block may be freed to any allocator
+/// of the same root, so objects can be created on one thread and destroyed
+/// on another. The chunks belong to the root.
 class b2BlockAllocator
 {
 public:
-	b2BlockAllocator();
+	/// @param allocator the source of the chunks, nullptr to use b2Alloc.
+	/// @param chunkSize the bytes of blocks in a chunk. Small chunks waste less memory
+	/// in allocators with few objects. This must be at least b2_maxBlockSize.
+	b2BlockAllocator(const b2Allocator* allocator = nullptr, int32 chunkSize = b2_chunkSize);
+
+	/// Construct a cache for another thread. The cache must be destroyed
+	/// before the root. The chunk callbacks must be thread-safe.
+	b2BlockAllocator(b2BlockAllocator* root);
+
+	/// A cache gives its free blocks back to the root.
 	~b2BlockAllocator();
 
-	/// Allocate memory. This will use b2Alloc if the size is larger than b2_maxBlockSize.
+	/// Allocate memory. This will use the chunk allocator if the size is larger than b2_maxBlockSize.
 	void* Allocate(int32 size);
 
-	/// Free memory. This will use b2Free if the size is larger than b2_maxBlockSize.
+	/// Free memory. This will use the chunk allocator if the size is larger than b2_maxBlockSize.
 	void Free(void* p, int32 size);
 
+	/// Make sure there are at least this many free blocks for allocations of this size.
+	void Reserve(int32 size, int32 count);
+
+	/// Give the free blocks of a cache back to the root, where any thread can take
+	/// them. This is thread-safe. It does nothing for the root.
+	void Flush();
+
+	/// Free all the chunks of a root. There must be no caches.
 	void Clear();
 
+	/// Get the number of chunks of a root.
+	int32 GetChunkCount() const;
+
+	/// Get the bytes of blocks in a chunk.
+	int32 GetChunkSize() const;
+
+	/// Get the callbacks used for chunks and large blocks.
+	const b2Allocator& GetAllocator() const;
+
+	/// Get the bytes in the free blocks of a root. The free blocks of caches
+	/// count as used. This walks the free lists and is not thread-safe.
+	int32 GetFreeByteCount() const;
+
+	/// Get the bytes at the end of the chunks of a root that are too small for a block.
+	int32 GetSlackByteCount() const;
+
+	/// Get the size of the block used for an allocation of this size.
+	static int32 GetBlockSize(int32 size);
+
+	/// Sort the free blocks of the size class of this size by address. The
+	/// following allocations of this size then return adjacent blocks where
+	/// possible. Used by b2World compaction.
+	void SortFreeList(int32 size);
+
 private:
 
-	b2Chunk* m_chunks;
-	int32 m_chunkCount;
-	int32 m_chunkSpace;
+	friend struct b2SizeMap;
+
+	b2Block* AllocateChunk(int32 index);
+
+	b2Allocator m_allocator;
+	b2BlockAllocator* m_root;
+	int32 m_chunkSize;
+
+	// Chunks of the root, pushed by any thread.
+	std::atomic<b2Chunk*> m_chunkList;
+	std::atomic<int32> m_chunkCount;
 
 	b2Block* m_freeLists[b2_blockSizes];
 
+	// Blocks of the root given back by caches. These are taken as a whole.
+	std::atomic<b2Block*> m_sharedLists[b2_blockSizes];
+
 	static int32 s_blockSizes[b2_blockSizes];
-	static uint8 s_blockSizeLookup[b2_maxBlockSize + 1];
-	static bool s_blockSizeLookupInitialized;
 };
 
 #endif
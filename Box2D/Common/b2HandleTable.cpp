@@ -0,0 +1,164 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Common/b2HandleTable.h"
+#include <string.h>
+
+b2HandleTable::b2HandleTable(const b2Allocator* allocator)
+{
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
+	m_entries = nullptr;
+	m_count = 0;
+	m_capacity = 0;
+	m_freeList = -1;
+	m_freeTail = -1;
+}
+
+b2HandleTable::~b2HandleTable()
+{
+	m_allocator.Free(m_entries);
+}
+
+// Grow the table and put the new entries at the end of the free list.
+void b2HandleTable::Grow(int32 capacity)
+{
+	if (capacity > e_maxCount)
+	{
+		capacity = e_maxCount;
+	}
+
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	b2HandleEntry* oldEntries = m_entries;
+	int32 oldCapacity = m_capacity;
+	m_capacity = capacity;
+
+	m_entries = (b2HandleEntry*)m_allocator.Allocate(m_capacity * sizeof(b2HandleEntry));
+	if (oldEntries)
+	{
+		memcpy(m_entries, oldEntries, oldCapacity * sizeof(b2HandleEntry));
+		m_allocator.Free(oldEntries);
+	}
+
+	for (int32 i = oldCapacity; i < m_capacity; ++i)
+	{
+		m_entries[i].object = nullptr;
+		m_entries[i].next = i + 1;
+		m_entries[i].generation = 1;
+	}
+	m_entries[m_capacity - 1].next = -1;
+
+	if (m_freeTail == -1)
+	{
+		m_freeList = oldCapacity;
+	}
+	else
+	{
+		m_entries[m_freeTail].next = oldCapacity;
+	}
+	m_freeTail = m_capacity - 1;
+}
+
+void b2HandleTable::Reserve(int32 count)
+{
+	Grow(count);
+}
+
+uint32 b2HandleTable::Create(void* object)
+{
+	// Grow before the free slots run low, so that a freed slot is not reused right away.
+	if (m_capacity - m_count < e_minFreeCount && m_capacity < e_maxCount)
+	{
+		Grow(m_capacity > 0 ? 2 * m_capacity : 64);
+	}
+
+	b2Assert(m_freeList != -1);
+	if (m_freeList == -1)
+	{
+		return b2_nullId;
+	}
+
+	int32 index = m_freeList;
+	b2HandleEntry* entry = m_entries + index;
+	m_freeList = entry->next;
+	if (m_freeList == -1)
+	{
+		m_freeTail = -1;
+	}
+
+	entry->object = object;
+	entry->next = -1;
+	++m_count;
+
+	return (uint32(index) << e_generationBits) | entry->generation;
+}
+
+void b2HandleTable::Destroy(uint32 handle)
+{
+	if (handle == b2_nullId)
+	{
+		return;
+	}
+
+	int32 index = int32(handle >> e_generationBits);
+	b2Assert(0 <= index && index < m_capacity);
+	b2HandleEntry* entry = m_entries + index;
+	b2Assert(entry->generation == (handle & e_generationMask));
+
+	// Invalidate the outstanding handles. Generation zero is never used so
+	// that no valid handle equals b2_nullId.
+	entry->generation = uint16((entry->generation + 1) & e_generationMask);
+	if (entry->generation == 0)
+	{
+		entry->generation = 1;
+	}
+
+	// Append the slot to the free list.
+	entry->object = nullptr;
+	entry->next = -1;
+	if (m_freeTail == -1)
+	{
+		m_freeList = index;
+	}
+	else
+	{
+		m_entries[m_freeTail].next = index;
+	}
+	m_freeTail = index;
+	--m_count;
+}
+
+void b2HandleTable::Set(uint32 handle, void* object)
+{
+	if (handle == b2_nullId)
+	{
+		return;
+	}
+
+	int32 index = int32(handle >> e_generationBits);
+	b2Assert(0 <= index && index < m_capacity);
+	b2Assert(m_entries[index].generation == (handle & e_generationMask));
+	m_entries[index].object = object;
+}
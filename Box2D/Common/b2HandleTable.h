@@ -0,0 +1,127 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HANDLE_TABLE_H
+#define B2_HANDLE_TABLE_H
+
+#include "Box2D/Common/b2Settings.h"
+
+/// A handle is a 32-bit id that refers to a world object. Unlike a pointer,
+/// a handle can be checked for validity after the object is destroyed. The
+/// low bits hold a generation that changes each time a slot is reused. An
+/// object created while its table is full gets b2_nullId.
+typedef uint32 b2BodyId;
+typedef uint32 b2FixtureId;
+typedef uint32 b2JointId;
+typedef uint32 b2ContactId;
+
+/// The null handle. No object has this handle.
+#define b2_nullId 0
+
+/// This maps handles to objects. The table can be updated when an
+/// object is relocated, so the handle stays valid. Freed slots are reused in
+/// the order they were freed and the table keeps at least e_minFreeCount slots
+/// free, so a stale handle can only match a new object after its slot has been
+/// reused e_generationMask times, each after e_minFreeCount other creations.
+class b2HandleTable
+{
+public:
+	enum
+	{
+		e_generationBits = 12,
+		e_generationMask = (1 << e_generationBits) - 1,
+		e_maxCount = 1 << (32 - e_generationBits),
+		e_minFreeCount = 64
+	};
+
+	b2HandleTable(const b2Allocator* allocator = nullptr);
+	~b2HandleTable();
+
+	/// Create a handle for an object.
+	/// @return b2_nullId if the table already holds e_maxCount handles.
+	uint32 Create(void* object);
+
+	/// Destroy a handle. The handle and its copies become invalid. The null
+	/// handle is ignored.
+	void Destroy(uint32 handle);
+
+	/// Get the object of a handle. Returns nullptr if the handle is not valid.
+	void* Get(uint32 handle) const;
+
+	/// Point a handle to a relocated object. The null handle is ignored.
+	void Set(uint32 handle, void* object);
+
+	/// Get the number of valid handles.
+	int32 GetCount() const;
+
+	/// Get the number of slots. The index of a handle is below this.
+	int32 GetCapacity() const;
+
+	/// Grow the table to hold at least this many handles.
+	void Reserve(int32 count);
+
+	/// Get the bytes of the table.
+	int32 GetByteCount() const;
+
+private:
+
+	void Grow(int32 capacity);
+
+	struct b2HandleEntry
+	{
+		void* object;
+		int32 next;
+		uint16 generation;
+	};
+
+	b2Allocator m_allocator;
+	b2HandleEntry* m_entries;
+	int32 m_count;
+	int32 m_capacity;
+	int32 m_freeList;
+	int32 m_freeTail;
+};
+
+inline void* b2HandleTable::Get(uint32 handle) const
+{
+	int32 index = int32(handle >> e_generationBits);
+	uint16 generation = uint16(handle & e_generationMask);
+	if (index >= m_capacity || m_entries[index].generation != generation)
+	{
+		return nullptr;
+	}
+
+	return m_entries[index].object;
+}
+
+inline int32 b2HandleTable::GetCount() const
+{
+	return m_count;
+}
+
+inline int32 b2HandleTable::GetCapacity() const
+{
+	return m_capacity;
+}
+
+inline int32 b2HandleTable::GetByteCount() const
+{
+	return m_capacity * sizeof(b2HandleEntry);
+}
+
+#endif
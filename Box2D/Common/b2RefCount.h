@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_REF_COUNT_H
+#define B2_REF_COUNT_H
+
+#include "Box2D/Common/b2Settings.h"
+#include <atomic>
+
+/// A thread-safe reference count for objects shared by worlds and threads.
+/// The count starts at one.
+class b2RefCount
+{
+public:
+	b2RefCount();
+
+	/// Add a reference.
+	void Retain();
+
+	/// Remove a reference.
+	/// @return true if this was the last reference. The caller may then destroy
+	/// the object, every use of the other references happens before.
+	bool Release();
+
+	/// Is this the only reference? Like the last Release, this sees every
+	/// use of the released references.
+	bool IsUnique() const;
+
+	/// Get the current count. This is only a hint while other threads hold references.
+	int32 GetCount() const;
+
+private:
+
+	std::atomic<int32> m_count;
+};
+
+inline b2RefCount::b2RefCount()
+	: m_count(1)
+{
+}
+
+inline void b2RefCount::Retain()
+{
+	// A new reference is made from an existing one, so it needs no ordering.
+	m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline bool b2RefCount::Release()
+{
+	return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+inline bool b2RefCount::IsUnique() const
+{
+	return m_count.load(std::memory_order_acquire) == 1;
+}
+
+inline int32 b2RefCount::GetCount() const
+{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+#endif
@@ -23,9 +23,13 @@
 
 b2Version b2_version = {2, 3, 2};
 
+// The allocations of this thread.
+static thread_local int32 b2_allocationCount = 0;
+
 // Memory allocators. Modify these to use your own allocator.
 void* b2Alloc(int32 size)
 {
+	++b2_allocationCount;
 	return malloc(size);
 }
 
@@ -34,6 +38,22 @@ void b2Free(void* mem)
 	free(mem);
 }
 
+void* b2Allocator::Allocate(int32 size) const
+{
+	if (allocFcn)
+	{
+		++b2_allocationCount;
+		return allocFcn(size, context);
+	}
+
+	return b2Alloc(size);
+}
+
+int32 b2GetAllocationCount()
+{
+	return b2_allocationCount;
+}
+
 // You can modify this to use your logging facility.
 void b2Log(const char* string, ...)
 {
@@ -53,6 +53,10 @@ typedef double float64;
 /// not change this value.
 #define b2_maxManifoldPoints	2
 
+/// The maximum number of collision layers, see b2World::SetLayerCollisionMatrix.
+/// Do not change this value.
+#define b2_maxCollisionLayers	32
+
 /// The maximum number of vertices on a convex polygon. You cannot increase
 /// this too much because b2BlockAllocator has a maximum object size.
 #define b2_maxPolygonVertices	8
@@ -137,6 +141,52 @@ void* b2Alloc(int32 size);
 /// If you implement b2Alloc, you should also implement this function.
 void b2Free(void* mem);
 
+/// Allocation callbacks of a world, see b2World::b2World.
+typedef void* b2AllocFcn(int32 size, void* context);
+typedef void b2FreeFcn(void* mem, void* context);
+
+/// A set of allocation callbacks with a user context. A world uses this for its allocators,
+/// broad-phase, arrays, handle tables, query snapshots and the vertices of its chain shapes,
+/// so each world can use its own memory. Shared shapes, static geometry and ropes still use
+/// b2Alloc. Set both callbacks or neither; null callbacks use b2Alloc and b2Free.
+struct b2Allocator
+{
+	b2Allocator()
+	{
+		allocFcn = nullptr;
+		freeFcn = nullptr;
+		context = nullptr;
+	}
+
+	void* Allocate(int32 size) const;
+
+	void Free(void* mem) const
+	{
+		if (mem == nullptr)
+		{
+			return;
+		}
+
+		if (freeFcn)
+		{
+			freeFcn(mem, context);
+		}
+		else
+		{
+			b2Free(mem);
+		}
+	}
+
+	b2AllocFcn* allocFcn;
+	b2FreeFcn* freeFcn;
+	void* context;
+};
+
+/// Get the number of allocations made on the calling thread by b2Alloc and
+/// b2Allocator. This is used to verify that time steps do not allocate, see
+/// b2World::SetAllocationCheck. Keep the count if you modify b2Alloc.
+int32 b2GetAllocationCount();
+
 /// Logging function.
 void b2Log(const char* string, ...);
 
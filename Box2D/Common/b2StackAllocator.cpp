@@ -19,9 +19,18 @@
 #include "Box2D/Common/b2StackAllocator.h"
 #include "Box2D/Common/b2Math.h"
 
-b2StackAllocator::b2StackAllocator()
+b2StackAllocator::b2StackAllocator(int32 size, const b2Allocator* allocator)
 {
-	m_index = 0;
+	b2Assert(size > 0);
+
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
+	m_blockCount = 0;
+	m_blockIndex = 0;
+	m_initialSize = size;
 	m_allocation = 0;
 	m_maxAllocation = 0;
 	m_entryCount = 0;
@@ -29,28 +38,110 @@ b2StackAllocator::b2StackAllocator()
 
 b2StackAllocator::~b2StackAllocator()
 {
-	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+
+	for (int32 i = 0; i < m_blockCount; ++i)
+	{
+		m_allocator.Free(m_blocks[i].data);
+	}
+}
+
+// Replace the blocks by a single block of the same total capacity.
+void b2StackAllocator::Merge()
+{
+	b2Assert(m_entryCount == 0);
+
+	int32 capacity = 0;
+	for (int32 i = 0; i < m_blockCount; ++i)
+	{
+		capacity += m_blocks[i].capacity;
+		m_allocator.Free(m_blocks[i].data);
+	}
+
+	m_blocks[0].data = (char*)m_allocator.Allocate(capacity);
+	m_blocks[0].capacity = capacity;
+	m_blocks[0].index = 0;
+	m_blockCount = 1;
+	m_blockIndex = 0;
+}
+
+void b2StackAllocator::Reserve(int32 size)
+{
+	b2Assert(m_entryCount == 0);
+
+	if (m_blockCount > 1)
+	{
+		Merge();
+	}
+
+	if (m_blockCount == 1 && m_blocks[0].capacity >= size)
+	{
+		return;
+	}
+
+	if (m_blockCount == 1)
+	{
+		m_allocator.Free(m_blocks[0].data);
+	}
+
+	m_blocks[0].capacity = b2Max(size, m_initialSize);
+	m_blocks[0].data = (char*)m_allocator.Allocate(m_blocks[0].capacity);
+	m_blocks[0].index = 0;
+	m_blockCount = 1;
+	m_blockIndex = 0;
 }
 
 void* b2StackAllocator::Allocate(int32 size)
 {
 	b2Assert(m_entryCount < b2_maxStackEntries);
 
-	b2StackEntry* entry = m_entries + m_entryCount;
-	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	// Keep the entries aligned for pointers and doubles.
+	size = (size + 7) & ~7;
+
+	if (m_blockCount == 0)
 	{
-		entry->data = (char*)b2Alloc(size);
-		entry->usedMalloc = true;
+		m_blocks[0].capacity = b2Max(m_initialSize, size);
+		m_blocks[0].data = (char*)m_allocator.Allocate(m_blocks[0].capacity);
+		m_blocks[0].index = 0;
+		m_blockCount = 1;
 	}
-	else
+	else if (m_entryCount == 0 && m_blockCount > 1)
 	{
-		entry->data = m_data + m_index;
-		entry->usedMalloc = false;
-		m_index += size;
+		Merge();
 	}
 
+	// Move to the next block if this one is full. The blocks after the
+	// current one are empty, a block that is too small is replaced.
+	b2StackBlock* block = m_blocks + m_blockIndex;
+	if (block->index + size > block->capacity)
+	{
+		int32 capacity = b2Max(2 * block->capacity, size);
+		++m_blockIndex;
+		b2Assert(m_blockIndex < b2_maxStackEntries);
+		block = m_blocks + m_blockIndex;
+
+		if (m_blockIndex == m_blockCount)
+		{
+			block->data = (char*)m_allocator.Allocate(capacity);
+			block->capacity = capacity;
+			block->index = 0;
+			++m_blockCount;
+		}
+		else if (block->capacity < size)
+		{
+			b2Assert(block->index == 0);
+			m_allocator.Free(block->data);
+			block->data = (char*)m_allocator.Allocate(capacity);
+			block->capacity = capacity;
+		}
+	}
+
+	b2StackEntry* entry = m_entries + m_entryCount;
+	entry->data = block->data + block->index;
+	entry->size = size;
+	entry->block = m_blockIndex;
+	block->index += size;
+
 	m_allocation += size;
 	m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
 	++m_entryCount;
@@ -63,21 +154,34 @@ void b2StackAllocator::Free(void* p)
 	b2Assert(m_entryCount > 0);
 	b2StackEntry* entry = m_entries + m_entryCount - 1;
 	b2Assert(p == entry->data);
-	if (entry->usedMalloc)
-	{
-		b2Free(p);
-	}
-	else
+
+	b2StackBlock* block = m_blocks + entry->block;
+	block->index -= entry->size;
+
+	// Step back over the empty blocks.
+	while (m_blockIndex > 0 && m_blocks[m_blockIndex].index == 0)
 	{
-		m_index -= entry->size;
+		--m_blockIndex;
 	}
+
 	m_allocation -= entry->size;
 	--m_entryCount;
 
-	p = nullptr;
+	B2_NOT_USED(p);
 }
 
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
 }
+
+int32 b2StackAllocator::GetCapacity() const
+{
+	int32 capacity = 0;
+	for (int32 i = 0; i < m_blockCount; ++i)
+	{
+		capacity += m_blocks[i].capacity;
+	}
+
+	return capacity;
+}
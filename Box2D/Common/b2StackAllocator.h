@@ -24,31 +24,56 @@
 const int32 b2_stackSize = 100 * 1024;	// 100k
 const int32 b2_maxStackEntries = 32;
 
+struct b2StackBlock
+{
+	char* data;
+	int32 capacity;
+	int32 index;
+};
+
 struct b2StackEntry
 {
 	char* data;
 	int32 size;
-	bool usedMalloc;
+	int32 block;
 };
 
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// The memory is a chain of blocks. A new block is added when the
+// current one is full and the blocks are kept, so the allocator
+// retains its high-water capacity. The blocks are merged into one
+// when the stack is empty.
 class b2StackAllocator
 {
 public:
-	b2StackAllocator();
+	/// @param size the size of the first block, allocated on first use.
+	/// @param allocator the source of the blocks, nullptr to use b2Alloc.
+	b2StackAllocator(int32 size = b2_stackSize, const b2Allocator* allocator = nullptr);
 	~b2StackAllocator();
 
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	/// Make sure a single block holds at least this many bytes. The stack must be empty.
+	void Reserve(int32 size);
+
 	int32 GetMaxAllocation() const;
 
+	/// Get the total size of the blocks.
+	int32 GetCapacity() const;
+
 private:
 
-	char m_data[b2_stackSize];
-	int32 m_index;
+	void Merge();
+
+	b2Allocator m_allocator;
+
+	b2StackBlock m_blocks[b2_maxStackEntries];
+	int32 m_blockCount;
+	int32 m_blockIndex;
+	int32 m_initialSize;
 
 	int32 m_allocation;
 	int32 m_maxAllocation;
@@ -20,14 +20,23 @@
 
 #if defined(_WIN32)
 
-float64 b2Timer::s_invFrequency = 0.0f;
-
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
 
 #include <windows.h>
 
+static float64 b2GetInvFrequency()
+{
+	LARGE_INTEGER largeInteger;
+	QueryPerformanceFrequency(&largeInteger);
+	float64 frequency = float64(largeInteger.QuadPart);
+	return frequency > 0.0f ? 1000.0f / frequency : 0.0f;
+}
+
+// Set during static initialization so that timers on separate threads do not race.
+float64 b2Timer::s_invFrequency = b2GetInvFrequency();
+
 b2Timer::b2Timer()
 {
 	LARGE_INTEGER largeInteger;
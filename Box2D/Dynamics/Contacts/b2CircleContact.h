@@ -21,14 +21,12 @@
 
 #include "Box2D/Dynamics/Contacts/b2Contact.h"
 
-class b2BlockAllocator;
-
 class b2CircleContact : public b2Contact
 {
 public:
 	static b2Contact* Create(	b2Fixture* fixtureA, int32 indexA,
-								b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
-	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+								b2Fixture* fixtureB, int32 indexB, void* mem);
+	static void Destroy(b2Contact* contact);
 
 	b2CircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
 	~b2CircleContact() {}
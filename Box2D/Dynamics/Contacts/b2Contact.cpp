@@ -29,13 +29,15 @@
 #include "Box2D/Collision/b2Collision.h"
 #include "Box2D/Collision/b2TimeOfImpact.h"
 #include "Box2D/Collision/Shapes/b2Shape.h"
-#include "Box2D/Common/b2BlockAllocator.h"
 #include "Box2D/Dynamics/b2Body.h"
 #include "Box2D/Dynamics/b2Fixture.h"
 #include "Box2D/Dynamics/b2World.h"
 
 b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
-bool b2Contact::s_initialized = false;
+
+// The registers are filled during static initialization, so worlds stepping
+// on separate threads only read them.
+bool b2Contact::s_initialized = (b2Contact::InitializeRegisters(), true);
 
 void b2Contact::InitializeRegisters()
 {
@@ -66,7 +68,33 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 	}
 }
 
-b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
+int32 b2Contact::GetArrayIndex(b2Shape::Type typeA, b2Shape::Type typeB)
+{
+	if (s_initialized == false)
+	{
+		InitializeRegisters();
+		s_initialized = true;
+	}
+
+	b2Assert(0 <= typeA && typeA < b2Shape::e_typeCount);
+	b2Assert(0 <= typeB && typeB < b2Shape::e_typeCount);
+
+	const b2ContactRegister& reg = s_registers[typeA][typeB];
+	if (reg.createFcn == nullptr)
+	{
+		return -1;
+	}
+
+	// The contact is created with the shape types in the order of the primary register.
+	if (reg.primary)
+	{
+		return typeA * b2Shape::e_typeCount + typeB;
+	}
+
+	return typeB * b2Shape::e_typeCount + typeA;
+}
+
+b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, void* mem)
 {
 	if (s_initialized == false)
 	{
@@ -85,11 +113,11 @@ b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtu
 	{
 		if (s_registers[type1][type2].primary)
 		{
-			return createFcn(fixtureA, indexA, fixtureB, indexB, allocator);
+			return createFcn(fixtureA, indexA, fixtureB, indexB, mem);
 		}
 		else
 		{
-			return createFcn(fixtureB, indexB, fixtureA, indexA, allocator);
+			return createFcn(fixtureB, indexB, fixtureA, indexA, mem);
 		}
 	}
 	else
@@ -98,16 +126,14 @@ b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtu
 	}
 }
 
-void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2Contact::Destroy(b2Contact* contact)
 {
 	b2Assert(s_initialized == true);
 
 	b2Fixture* fixtureA = contact->m_fixtureA;
 	b2Fixture* fixtureB = contact->m_fixtureB;
 
-	if (contact->m_manifold.pointCount > 0 &&
-		fixtureA->IsSensor() == false &&
-		fixtureB->IsSensor() == false)
+	if (contact->m_manifold.pointCount > 0)
 	{
 		fixtureA->GetBody()->SetAwake(true);
 		fixtureB->GetBody()->SetAwake(true);
@@ -120,12 +146,21 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 	b2Assert(0 <= typeA && typeB < b2Shape::e_typeCount);
 
 	b2ContactDestroyFcn* destroyFcn = s_registers[typeA][typeB].destroyFcn;
-	destroyFcn(contact, allocator);
+	destroyFcn(contact);
 }
 
 b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 {
 	m_flags = e_enabledFlag;
+	if (fA->m_enableImpulseEvents || fB->m_enableImpulseEvents)
+	{
+		m_flags |= e_impulseEventsFlag;
+	}
+
+	if (fA->m_oneSided || fB->m_oneSided)
+	{
+		m_flags |= e_oneSidedFlag;
+	}
 
 	m_fixtureA = fA;
 	m_fixtureB = fB;
@@ -137,6 +172,8 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 	m_prev = nullptr;
 	m_next = nullptr;
+	m_managerIndex = -1;
+	m_id = b2_nullId;
 
 	m_nodeA.contact = nullptr;
 	m_nodeA.prev = nullptr;
@@ -158,67 +195,51 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactManager* contactManager)
 {
+	b2ContactListener* listener = contactManager->m_contactListener;
+
 	b2Manifold oldManifold = m_manifold;
 
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
-	bool touching = false;
 	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
-	bool sensorA = m_fixtureA->IsSensor();
-	bool sensorB = m_fixtureB->IsSensor();
-	bool sensor = sensorA || sensorB;
-
 	b2Body* bodyA = m_fixtureA->GetBody();
 	b2Body* bodyB = m_fixtureB->GetBody();
 	const b2Transform& xfA = bodyA->GetTransform();
 	const b2Transform& xfB = bodyB->GetTransform();
 
-	// Is this contact a sensor?
-	if (sensor)
-	{
-		const b2Shape* shapeA = m_fixtureA->GetShape();
-		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+	Evaluate(&m_manifold, xfA, xfB);
+	bool touching = m_manifold.pointCount > 0;
 
-		// Sensors don't generate manifolds.
-		m_manifold.pointCount = 0;
-	}
-	else
+	// Match old contact ids to new contact ids and copy the
+	// stored impulses to warm start the solver.
+	for (int32 i = 0; i < m_manifold.pointCount; ++i)
 	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
+		b2ManifoldPoint* mp2 = m_manifold.points + i;
+		mp2->normalImpulse = 0.0f;
+		mp2->tangentImpulse = 0.0f;
+		b2ContactID id2 = mp2->id;
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int32 i = 0; i < m_manifold.pointCount; ++i)
+		for (int32 j = 0; j < oldManifold.pointCount; ++j)
 		{
-			b2ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			b2ContactID id2 = mp2->id;
+			b2ManifoldPoint* mp1 = oldManifold.points + j;
 
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
+			if (mp1->id.key == id2.key)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
-
-				if (mp1->id.key == id2.key)
-				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
-				}
+				mp2->normalImpulse = mp1->normalImpulse;
+				mp2->tangentImpulse = mp1->tangentImpulse;
+				break;
 			}
 		}
+	}
 
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
+	if (touching != wasTouching)
+	{
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
 	}
 
 	if (touching)
@@ -230,18 +251,82 @@ void b2Contact::Update(b2ContactListener* listener)
 		m_flags &= ~e_touchingFlag;
 	}
 
-	if (wasTouching == false && touching == true && listener)
+	if (wasTouching == false && touching == true)
 	{
-		listener->BeginContact(this);
+		if (listener)
+		{
+			listener->BeginContact(this);
+		}
+
+		contactManager->ReportBeginTouch(this);
+	}
+
+	if (wasTouching == true && touching == false)
+	{
+		if (listener)
+		{
+			listener->EndContact(this);
+		}
+
+		contactManager->ReportEndTouch(this);
 	}
 
-	if (wasTouching == true && touching == false && listener)
+	// One-sided fixtures decide once, when the shapes begin touching. This way a
+	// shape that is passing through a platform is not pushed out half way.
+	if (m_flags & e_oneSidedFlag)
 	{
-		listener->EndContact(this);
+		if (touching == false)
+		{
+			m_flags &= ~e_oneSidedRejectFlag;
+		}
+		else if (wasTouching == false && TestOneSided() == false)
+		{
+			m_flags |= e_oneSidedRejectFlag;
+		}
+
+		if (m_flags & e_oneSidedRejectFlag)
+		{
+			m_flags &= ~e_enabledFlag;
+		}
 	}
 
-	if (sensor == false && touching && listener)
+	if (touching && listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
 }
+
+bool b2Contact::TestOneSided() const
+{
+	// The contact is accepted if the normal is within 60 degrees of
+	// the one-sided normal.
+	const float32 minCosine = 0.5f;
+
+	const b2Body* bodyA = m_fixtureA->GetBody();
+	const b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2WorldManifold worldManifold;
+	worldManifold.Initialize(&m_manifold, bodyA->GetTransform(), m_fixtureA->m_shape->m_radius,
+							 bodyB->GetTransform(), m_fixtureB->m_shape->m_radius);
+
+	// The world normal points from A to B.
+	if (m_fixtureA->m_oneSided)
+	{
+		b2Vec2 normal = b2Mul(bodyA->GetTransform().q, m_fixtureA->m_oneSidedNormal);
+		if (b2Dot(worldManifold.normal, normal) < minCosine)
+		{
+			return false;
+		}
+	}
+
+	if (m_fixtureB->m_oneSided)
+	{
+		b2Vec2 normal = b2Mul(bodyB->GetTransform().q, m_fixtureB->m_oneSidedNormal);
+		if (b2Dot(worldManifold.normal, normal) > -minCosine)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
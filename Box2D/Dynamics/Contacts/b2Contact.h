@@ -28,9 +28,9 @@ class b2Body;
 class b2Contact;
 class b2Fixture;
 class b2World;
-class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactManager;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the restitution to zero.
 /// For example, anything slides on ice.
@@ -48,8 +48,8 @@ inline float32 b2MixRestitution(float32 restitution1, float32 restitution2)
 
 typedef b2Contact* b2ContactCreateFcn(	b2Fixture* fixtureA, int32 indexA,
 										b2Fixture* fixtureB, int32 indexB,
-										b2BlockAllocator* allocator);
-typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
+										void* mem);
+typedef void b2ContactDestroyFcn(b2Contact* contact);
 
 struct b2ContactRegister
 {
@@ -101,6 +101,10 @@ public:
 	b2Contact* GetNext();
 	const b2Contact* GetNext() const;
 
+	/// Get the handle of this contact. The handle is invalid after the contact is destroyed.
+	/// @see b2World::GetContact
+	b2ContactId GetId() const;
+
 	/// Get fixture A in this contact.
 	b2Fixture* GetFixtureA();
 	const b2Fixture* GetFixtureA() const;
@@ -150,6 +154,7 @@ protected:
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2Island;
 
 	// Flags stored in m_flags
 	enum
@@ -170,24 +175,43 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// A fixture of this contact has impulse events enabled
+		e_impulseEventsFlag	= 0x0040,
+
+		// A fixture of this contact is one-sided
+		e_oneSidedFlag		= 0x0080,
+
+		// This contact began touching from the back of a one-sided fixture
+		e_oneSidedRejectFlag	= 0x0100,
+
+		// A begin touch event was buffered, so an end touch event is owed
+		e_beginEventFlag	= 0x0400
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
 	void FlagForFiltering();
 
+	// Test the manifold normal against the one-sided fixture normals.
+	bool TestOneSided() const;
+
 	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
 						b2Shape::Type typeA, b2Shape::Type typeB);
 	static void InitializeRegisters();
-	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
-	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
-	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+	// Get the index of the contact array for these shape types, see b2ContactManager.
+	// Returns -1 if the shapes don't collide.
+	static int32 GetArrayIndex(b2Shape::Type typeA, b2Shape::Type typeB);
+
+	// Construct a contact in memory provided by the contact manager.
+	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, void* mem);
+	static void Destroy(b2Contact* contact);
 
 	b2Contact() : m_fixtureA(nullptr), m_fixtureB(nullptr) {}
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	void Update(b2ContactManager* contactManager);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -198,6 +222,11 @@ protected:
 	b2Contact* m_prev;
 	b2Contact* m_next;
 
+	// Index in the contact array of the shape types, see b2ContactManager.
+	int32 m_managerIndex;
+
+	b2ContactId m_id;
+
 	// Nodes for connecting bodies.
 	b2ContactEdge m_nodeA;
 	b2ContactEdge m_nodeB;
@@ -271,6 +300,11 @@ inline const b2Contact* b2Contact::GetNext() const
 	return m_next;
 }
 
+inline b2ContactId b2Contact::GetId() const
+{
+	return m_id;
+}
+
 inline b2Fixture* b2Contact::GetFixtureA()
 {
 	return m_fixtureA;
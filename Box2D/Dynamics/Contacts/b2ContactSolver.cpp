@@ -79,10 +79,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->tangentSpeed = contact->m_tangentSpeed;
 		vc->indexA = bodyA->m_islandIndex;
 		vc->indexB = bodyB->m_islandIndex;
-		vc->invMassA = bodyA->m_invMass;
-		vc->invMassB = bodyB->m_invMass;
-		vc->invIA = bodyA->m_invI;
-		vc->invIB = bodyB->m_invI;
+		vc->invMassA = bodyA->InvMass();
+		vc->invMassB = bodyB->InvMass();
+		vc->invIA = bodyA->InvI();
+		vc->invIB = bodyB->InvI();
 		vc->contactIndex = i;
 		vc->pointCount = pointCount;
 		vc->K.SetZero();
@@ -91,12 +91,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
 		pc->indexA = bodyA->m_islandIndex;
 		pc->indexB = bodyB->m_islandIndex;
-		pc->invMassA = bodyA->m_invMass;
-		pc->invMassB = bodyB->m_invMass;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
-		pc->invIA = bodyA->m_invI;
-		pc->invIB = bodyB->m_invI;
+		pc->invMassA = bodyA->InvMass();
+		pc->invMassB = bodyB->InvMass();
+		pc->localCenterA = bodyA->Sweep().localCenter;
+		pc->localCenterB = bodyB->Sweep().localCenter;
+		pc->invIA = bodyA->InvI();
+		pc->invIB = bodyB->InvI();
 		pc->localNormal = manifold->localNormal;
 		pc->localPoint = manifold->localPoint;
 		pc->pointCount = pointCount;
@@ -78,6 +78,7 @@ public:
 protected:
 
 	friend class b2Joint;
+	friend class b2World;
 	b2GearJoint(const b2GearJointDef* data);
 
 	void InitVelocityConstraints(const b2SolverData& data) override;
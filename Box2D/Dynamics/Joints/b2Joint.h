@@ -20,6 +20,7 @@
 #define B2_JOINT_H
 
 #include "Box2D/Common/b2Math.h"
+#include "Box2D/Common/b2HandleTable.h"
 
 class b2Body;
 class b2Joint;
@@ -80,6 +81,8 @@ struct b2JointDef
 		bodyA = nullptr;
 		bodyB = nullptr;
 		collideConnected = false;
+		breakForce = b2_maxFloat;
+		breakTorque = b2_maxFloat;
 	}
 
 	/// The joint type is set automatically for concrete joint types.
@@ -96,6 +99,26 @@ struct b2JointDef
 
 	/// Set this flag to true if the attached bodies should collide.
 	bool collideConnected;
+
+	/// The joint breaks when the magnitude of its reaction force exceeds this value, in Newtons.
+	/// The gear joints that use a broken joint break with it.
+	float32 breakForce;
+
+	/// The joint breaks when the magnitude of its reaction torque exceeds this value, in N*m.
+	float32 breakTorque;
+};
+
+/// A joint break event is reported when a joint exceeds its break force or torque.
+/// The joint is destroyed after the time step, so the joint pointer must only be
+/// used to identify the joint.
+struct b2JointBreakEvent
+{
+	b2Joint* joint;
+	void* userData;
+	b2Body* bodyA;
+	b2Body* bodyB;
+	b2Vec2 reactionForce;
+	float32 reactionTorque;
 };
 
 /// The base joint class. Joints are used to constraint two bodies together in
@@ -129,6 +152,10 @@ public:
 	b2Joint* GetNext();
 	const b2Joint* GetNext() const;
 
+	/// Get the handle of this joint. The handle is invalid after the joint is destroyed.
+	/// @see b2World::GetJoint
+	b2JointId GetId() const;
+
 	/// Get the user data pointer.
 	void* GetUserData() const;
 
@@ -138,6 +165,18 @@ public:
 	/// Short-cut function to determine if either body is inactive.
 	bool IsActive() const;
 
+	/// Set the break force threshold. Use b2_maxFloat for an unbreakable joint.
+	void SetBreakForce(float32 force);
+
+	/// Get the break force threshold.
+	float32 GetBreakForce() const;
+
+	/// Set the break torque threshold. Use b2_maxFloat for an unbreakable joint.
+	void SetBreakTorque(float32 torque);
+
+	/// Get the break torque threshold.
+	float32 GetBreakTorque() const;
+
 	/// Get collide connected.
 	/// Note: modifying the collide connect flag won't work correctly because
 	/// the flag is only checked when fixture AABBs begin to overlap.
@@ -158,6 +197,9 @@ protected:
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
 
+	// The allocation size of a joint type.
+	static int32 GetSize(b2JointType type);
+
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
@@ -180,6 +222,12 @@ protected:
 	bool m_islandFlag;
 	bool m_collideConnected;
 
+	float32 m_breakForce;
+	float32 m_breakTorque;
+	bool m_breakable;
+
+	b2JointId m_id;
+
 	void* m_userData;
 };
 
@@ -208,6 +256,11 @@ inline const b2Joint* b2Joint::GetNext() const
 	return m_next;
 }
 
+inline b2JointId b2Joint::GetId() const
+{
+	return m_id;
+}
+
 inline void* b2Joint::GetUserData() const
 {
 	return m_userData;
@@ -218,6 +271,28 @@ inline void b2Joint::SetUserData(void* data)
 	m_userData = data;
 }
 
+inline void b2Joint::SetBreakForce(float32 force)
+{
+	m_breakForce = force;
+	m_breakable = m_breakForce < b2_maxFloat || m_breakTorque < b2_maxFloat;
+}
+
+inline float32 b2Joint::GetBreakForce() const
+{
+	return m_breakForce;
+}
+
+inline void b2Joint::SetBreakTorque(float32 torque)
+{
+	m_breakTorque = torque;
+	m_breakable = m_breakForce < b2_maxFloat || m_breakTorque < b2_maxFloat;
+}
+
+inline float32 b2Joint::GetBreakTorque() const
+{
+	return m_breakTorque;
+}
+
 inline bool b2Joint::GetCollideConnected() const
 {
 	return m_collideConnected;
@@ -56,30 +56,39 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_world = world;
 
-	m_xf.p = bd->position;
-	m_xf.q.Set(bd->angle);
-
-	m_sweep.localCenter.SetZero();
-	m_sweep.c0 = m_xf.p;
-	m_sweep.c = m_xf.p;
-	m_sweep.a0 = bd->angle;
-	m_sweep.a = bd->angle;
-	m_sweep.alpha0 = 0.0f;
+	// The world has room for the state at the end of its arrays.
+	m_arrays = &world->m_bodyArrays;
+	m_worldIndex = world->m_bodyCount;
+
+	b2Transform& xf = Transform();
+	xf.p = bd->position;
+	xf.q.Set(bd->angle);
+
+	b2Sweep& sweep = Sweep();
+	sweep.localCenter.SetZero();
+	sweep.c0 = xf.p;
+	sweep.c = xf.p;
+	sweep.a0 = bd->angle;
+	sweep.a = bd->angle;
+	sweep.alpha0 = 0.0f;
 
 	m_jointList = nullptr;
+	m_bodyPairCount = 0;
 	m_contactList = nullptr;
+	m_pairList = b2_nullPair;
+	m_id = b2_nullId;
 	m_prev = nullptr;
 	m_next = nullptr;
 
-	m_linearVelocity = bd->linearVelocity;
-	m_angularVelocity = bd->angularVelocity;
+	LinearVelocity() = bd->linearVelocity;
+	AngularVelocity() = bd->angularVelocity;
 
 	m_linearDamping = bd->linearDamping;
 	m_angularDamping = bd->angularDamping;
 	m_gravityScale = bd->gravityScale;
 
-	m_force.SetZero();
-	m_torque = 0.0f;
+	Force().SetZero();
+	Torque() = 0.0f;
 
 	m_sleepTime = 0.0f;
 
@@ -88,16 +97,16 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	if (m_type == b2_dynamicBody)
 	{
 		m_mass = 1.0f;
-		m_invMass = 1.0f;
+		InvMass() = 1.0f;
 	}
 	else
 	{
 		m_mass = 0.0f;
-		m_invMass = 0.0f;
+		InvMass() = 0.0f;
 	}
 
 	m_I = 0.0f;
-	m_invI = 0.0f;
+	InvI() = 0.0f;
 
 	m_userData = bd->userData;
 
@@ -118,6 +127,13 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	// The fixtures of the static geometry body cannot leave the static tree.
+	b2Assert(this != m_world->m_staticGeometryBody);
+	if (this == m_world->m_staticGeometryBody)
+	{
+		return;
+	}
+
 	if (m_type == type)
 	{
 		return;
@@ -129,17 +145,17 @@ void b2Body::SetType(b2BodyType type)
 
 	if (m_type == b2_staticBody)
 	{
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_sweep.a0 = m_sweep.a;
-		m_sweep.c0 = m_sweep.c;
+		LinearVelocity().SetZero();
+		AngularVelocity() = 0.0f;
+		Sweep().a0 = Sweep().a;
+		Sweep().c0 = Sweep().c;
 		SynchronizeFixtures();
 	}
 
 	SetAwake(true);
 
-	m_force.SetZero();
-	m_torque = 0.0f;
+	Force().SetZero();
+	Torque() = 0.0f;
 
 	// Delete the attached contacts.
 	b2ContactEdge* ce = m_contactList;
@@ -150,6 +166,14 @@ void b2Body::SetType(b2BodyType type)
 		m_world->m_contactManager.Destroy(ce0->contact);
 	}
 	m_contactList = nullptr;
+	m_world->m_contactManager.DestroyPairs(this, nullptr);
+
+	// Sensor overlaps are filtered again when the pairs are reported.
+	b2SensorManager* sensorManager = &m_world->m_contactManager.m_sensorManager;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		sensorManager->RemoveFixture(f);
+	}
 
 	// Touch the proxies so that new contacts will be created (when appropriate)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
@@ -171,16 +195,22 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 		return nullptr;
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
+	b2BlockAllocator* allocator = m_world->m_blockAllocator;
 
 	void* memory = allocator->Allocate(sizeof(b2Fixture));
 	b2Fixture* fixture = new (memory) b2Fixture;
 	fixture->Create(allocator, this, def);
+	fixture->m_id = m_world->m_fixtureIds.Create(fixture);
+
+	if (fixture->m_isSensor)
+	{
+		fixture->m_sensor = m_world->m_contactManager.m_sensorManager.CreateSensor(fixture);
+	}
 
 	if (m_flags & e_activeFlag)
 	{
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
-		fixture->CreateProxies(broadPhase, m_xf);
+		fixture->CreateProxies(broadPhase, Transform());
 	}
 
 	fixture->m_next = m_fixtureList;
@@ -211,6 +241,15 @@ b2Fixture* b2Body::CreateFixture(const b2Shape* shape, float32 density)
 	return CreateFixture(&def);
 }
 
+b2Fixture* b2Body::CreateFixture(b2SharedShape* shape, float32 density)
+{
+	b2FixtureDef def;
+	def.sharedShape = shape;
+	def.density = density;
+
+	return CreateFixture(&def);
+}
+
 void b2Body::DestroyFixture(b2Fixture* fixture)
 {
 	if (fixture == nullptr)
@@ -224,6 +263,13 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 		return;
 	}
 
+	// Fixtures of the static geometry are destroyed with their body.
+	b2Assert(fixture->m_shared == false);
+	if (fixture->m_shared)
+	{
+		return;
+	}
+
 	b2Assert(fixture->m_body == this);
 
 	// Remove the fixture from this body's singly linked list.
@@ -263,13 +309,27 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 		}
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
+	m_world->m_contactManager.DestroyPairs(this, fixture);
+
+	// Destroy any sensor overlaps associated with the fixture.
+	b2SensorManager* sensorManager = &m_world->m_contactManager.m_sensorManager;
+	sensorManager->RemoveFixture(fixture);
+	if (fixture->m_sensor)
+	{
+		sensorManager->DestroySensor(fixture->m_sensor);
+		fixture->m_sensor = nullptr;
+	}
+
+	b2BlockAllocator* allocator = m_world->m_blockAllocator;
 
 	if (m_flags & e_activeFlag)
 	{
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		fixture->DestroyProxies(broadPhase);
 	}
+	fixture->ClearTriggerEvents(&m_world->m_contactManager.m_broadPhase);
+
+	m_world->m_fixtureIds.Destroy(fixture->m_id);
 
 	fixture->m_body = nullptr;
 	fixture->m_next = nullptr;
@@ -287,17 +347,18 @@ void b2Body::ResetMassData()
 {
 	// Compute mass data from shapes. Each shape has its own density.
 	m_mass = 0.0f;
-	m_invMass = 0.0f;
+	InvMass() = 0.0f;
 	m_I = 0.0f;
-	m_invI = 0.0f;
-	m_sweep.localCenter.SetZero();
+	InvI() = 0.0f;
+	Sweep().localCenter.SetZero();
 
 	// Static and kinematic bodies have zero mass.
 	if (m_type == b2_staticBody || m_type == b2_kinematicBody)
 	{
-		m_sweep.c0 = m_xf.p;
-		m_sweep.c = m_xf.p;
-		m_sweep.a0 = m_sweep.a;
+		b2Sweep& sweep = Sweep();
+		sweep.c0 = Transform().p;
+		sweep.c = sweep.c0;
+		sweep.a0 = sweep.a;
 		return;
 	}
 
@@ -322,14 +383,14 @@ void b2Body::ResetMassData()
 	// Compute center of mass.
 	if (m_mass > 0.0f)
 	{
-		m_invMass = 1.0f / m_mass;
-		localCenter *= m_invMass;
+		InvMass() = 1.0f / m_mass;
+		localCenter *= InvMass();
 	}
 	else
 	{
 		// Force all dynamic bodies to have a positive mass.
 		m_mass = 1.0f;
-		m_invMass = 1.0f;
+		InvMass() = 1.0f;
 	}
 
 	if (m_I > 0.0f && (m_flags & e_fixedRotationFlag) == 0)
@@ -337,22 +398,23 @@ void b2Body::ResetMassData()
 		// Center the inertia about the center of mass.
 		m_I -= m_mass * b2Dot(localCenter, localCenter);
 		b2Assert(m_I > 0.0f);
-		m_invI = 1.0f / m_I;
+		InvI() = 1.0f / m_I;
 
 	}
 	else
 	{
 		m_I = 0.0f;
-		m_invI = 0.0f;
+		InvI() = 0.0f;
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter = localCenter;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Sweep& sweep = Sweep();
+	b2Vec2 oldCenter = sweep.c;
+	sweep.localCenter = localCenter;
+	sweep.c0 = sweep.c = b2Mul(Transform(), sweep.localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	LinearVelocity() += b2Cross(AngularVelocity(), sweep.c - oldCenter);
 }
 
 void b2Body::SetMassData(const b2MassData* massData)
@@ -368,9 +430,9 @@ void b2Body::SetMassData(const b2MassData* massData)
 		return;
 	}
 
-	m_invMass = 0.0f;
+	InvMass() = 0.0f;
 	m_I = 0.0f;
-	m_invI = 0.0f;
+	InvI() = 0.0f;
 
 	m_mass = massData->mass;
 	if (m_mass <= 0.0f)
@@ -378,22 +440,23 @@ void b2Body::SetMassData(const b2MassData* massData)
 		m_mass = 1.0f;
 	}
 
-	m_invMass = 1.0f / m_mass;
+	InvMass() = 1.0f / m_mass;
 
 	if (massData->I > 0.0f && (m_flags & b2Body::e_fixedRotationFlag) == 0)
 	{
 		m_I = massData->I - m_mass * b2Dot(massData->center, massData->center);
 		b2Assert(m_I > 0.0f);
-		m_invI = 1.0f / m_I;
+		InvI() = 1.0f / m_I;
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter =  massData->center;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Sweep& sweep = Sweep();
+	b2Vec2 oldCenter = sweep.c;
+	sweep.localCenter = massData->center;
+	sweep.c0 = sweep.c = b2Mul(Transform(), sweep.localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	LinearVelocity() += b2Cross(AngularVelocity(), sweep.c - oldCenter);
 }
 
 bool b2Body::ShouldCollide(const b2Body* other) const
@@ -409,19 +472,13 @@ bool b2Body::ShouldCollide(const b2Body* other) const
 
 bool b2Body::ShouldCollideConnected(const b2Body* other) const
 {
-	// Does a joint prevent collision?
-	for (b2JointEdge* jn = m_jointList; jn; jn = jn->next)
+	// Joints and users add ignore pairs. Most bodies have none.
+	if (m_bodyPairCount == 0 || other->m_bodyPairCount == 0)
 	{
-		if (jn->other == other)
-		{
-			if (jn->joint->m_collideConnected == false)
-			{
-				return false;
-			}
-		}
+		return true;
 	}
 
-	return true;
+	return m_world->m_ignorePairs.Contains(this, other) == false;
 }
 
 void b2Body::SetTransform(const b2Vec2& position, float32 angle)
@@ -432,32 +489,42 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 		return;
 	}
 
-	m_xf.q.Set(angle);
-	m_xf.p = position;
+	// The static geometry is in world coordinates.
+	b2Assert(this != m_world->m_staticGeometryBody);
+	if (this == m_world->m_staticGeometryBody)
+	{
+		return;
+	}
+
+	b2Transform& xf = Transform();
+	xf.q.Set(angle);
+	xf.p = position;
 
-	m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
-	m_sweep.a = angle;
+	b2Sweep& sweep = Sweep();
+	sweep.c = b2Mul(xf, sweep.localCenter);
+	sweep.a = angle;
 
-	m_sweep.c0 = m_sweep.c;
-	m_sweep.a0 = angle;
+	sweep.c0 = sweep.c;
+	sweep.a0 = angle;
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		f->Synchronize(broadPhase, m_xf, m_xf);
+		f->Synchronize(broadPhase, xf, xf);
 	}
 }
 
 void b2Body::SynchronizeFixtures()
 {
+	const b2Sweep& sweep = Sweep();
 	b2Transform xf1;
-	xf1.q.Set(m_sweep.a0);
-	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	xf1.q.Set(sweep.a0);
+	xf1.p = sweep.c0 - b2Mul(xf1.q, sweep.localCenter);
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		f->Synchronize(broadPhase, xf1, m_xf);
+		f->Synchronize(broadPhase, xf1, Transform());
 	}
 }
 
@@ -465,6 +532,13 @@ void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
 
+	// The proxies of the static geometry cannot be removed.
+	b2Assert(this != m_world->m_staticGeometryBody);
+	if (this == m_world->m_staticGeometryBody)
+	{
+		return;
+	}
+
 	if (flag == IsActive())
 	{
 		return;
@@ -478,7 +552,7 @@ void b2Body::SetActive(bool flag)
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
-			f->CreateProxies(broadPhase, m_xf);
+			f->CreateProxies(broadPhase, Transform());
 		}
 
 		// Contacts are created the next time step.
@@ -487,10 +561,12 @@ void b2Body::SetActive(bool flag)
 	{
 		m_flags &= ~e_activeFlag;
 
-		// Destroy all proxies.
+		// Destroy all proxies and the sensor overlaps that refer to them.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		b2SensorManager* sensorManager = &m_world->m_contactManager.m_sensorManager;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
+			sensorManager->RemoveFixture(f);
 			f->DestroyProxies(broadPhase);
 		}
 
@@ -503,6 +579,7 @@ void b2Body::SetActive(bool flag)
 			m_world->m_contactManager.Destroy(ce0->contact);
 		}
 		m_contactList = nullptr;
+		m_world->m_contactManager.DestroyPairs(this, nullptr);
 	}
 }
 
@@ -523,7 +600,7 @@ void b2Body::SetFixedRotation(bool flag)
 		m_flags &= ~e_fixedRotationFlag;
 	}
 
-	m_angularVelocity = 0.0f;
+	AngularVelocity() = 0.0f;
 
 	ResetMassData();
 }
@@ -535,10 +612,10 @@ void b2Body::Dump()
 	b2Log("{\n");
 	b2Log("  b2BodyDef bd;\n");
 	b2Log("  bd.type = b2BodyType(%d);\n", m_type);
-	b2Log("  bd.position.Set(%.15lef, %.15lef);\n", m_xf.p.x, m_xf.p.y);
-	b2Log("  bd.angle = %.15lef;\n", m_sweep.a);
-	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", m_linearVelocity.x, m_linearVelocity.y);
-	b2Log("  bd.angularVelocity = %.15lef;\n", m_angularVelocity);
+	b2Log("  bd.position.Set(%.15lef, %.15lef);\n", Transform().p.x, Transform().p.y);
+	b2Log("  bd.angle = %.15lef;\n", Sweep().a);
+	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", LinearVelocity().x, LinearVelocity().y);
+	b2Log("  bd.angularVelocity = %.15lef;\n", AngularVelocity());
 	b2Log("  bd.linearDamping = %.15lef;\n", m_linearDamping);
 	b2Log("  bd.angularDamping = %.15lef;\n", m_angularDamping);
 	b2Log("  bd.allowSleep = bool(%d);\n", m_flags & e_autoSleepFlag);
@@ -20,6 +20,7 @@
 #define B2_BODY_H
 
 #include "Box2D/Common/b2Math.h"
+#include "Box2D/Common/b2HandleTable.h"
 #include "Box2D/Collision/Shapes/b2Shape.h"
 #include <memory>
 
@@ -27,6 +28,7 @@ class b2Fixture;
 class b2Joint;
 class b2Contact;
 class b2Controller;
+class b2SharedShape;
 class b2World;
 struct b2FixtureDef;
 struct b2JointEdge;
@@ -122,6 +124,20 @@ struct b2BodyDef
 	float32 gravityScale;
 };
 
+/// The simulation state of the bodies of a world, one array per field. The
+/// arrays are indexed like the world body array, see b2Body::m_worldIndex.
+struct b2BodyArrays
+{
+	b2Transform* transforms;
+	b2Sweep* sweeps;
+	b2Vec2* linearVelocities;
+	float32* angularVelocities;
+	b2Vec2* forces;
+	float32* torques;
+	float32* invMasses;
+	float32* invIs;
+};
+
 /// A rigid body. These are created via b2World::CreateBody.
 class b2Body
 {
@@ -144,6 +160,13 @@ public:
 	/// @warning This function is locked during callbacks.
 	b2Fixture* CreateFixture(const b2Shape* shape, float32 density);
 
+	/// Creates a fixture that references a shared shape and attach it to this body.
+	/// This is a convenience function, see b2FixtureDef::sharedShape.
+	/// @param shape the shared shape, the fixture holds a reference to it.
+	/// @param density the shape density (set to zero for static bodies).
+	/// @warning This function is locked during callbacks.
+	b2Fixture* CreateFixture(b2SharedShape* shape, float32 density);
+
 	/// Destroy a fixture. This removes the fixture from the broad-phase and
 	/// destroys all contacts associated with this fixture. This will
 	/// automatically adjust the mass of the body if the body is dynamic and the
@@ -160,7 +183,9 @@ public:
 	/// @param angle the world rotation in radians.
 	void SetTransform(const b2Vec2& position, float32 angle);
 
-	/// Get the body transform for the body's origin.
+	/// Get the body transform for the body's origin. The body state is stored
+	/// in arrays of the world, so the references returned by this and the other
+	/// getters are only valid until the next body is created or destroyed.
 	/// @return the world transform of the body's origin.
 	const b2Transform& GetTransform() const;
 
@@ -374,6 +399,10 @@ public:
 	b2Body* GetNext();
 	const b2Body* GetNext() const;
 
+	/// Get the handle of this body. The handle is invalid after the body is destroyed.
+	/// @see b2World::GetBody
+	b2BodyId GetId() const;
+
 	/// Get the user data pointer that was provided in the body definition.
 	void* GetUserData() const;
 
@@ -384,7 +413,7 @@ public:
 	b2World* GetWorld();
 	const b2World* GetWorld() const;
 
-	/// Does a joint prevent collision?
+	/// Does a joint or b2World::IgnoreCollision prevent collision?
 	bool ShouldCollideConnected(const b2Body* other) const;
 
 	/// Dump this body to a log file
@@ -393,6 +422,7 @@ public:
 private:
 
 	friend class b2World;
+	friend class b2BodyPairSet;
 	friend class b2Island;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
@@ -419,7 +449,8 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_compactFlag		= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -434,41 +465,68 @@ private:
 
 	void Advance(float32 t);
 
+	// The simulation state in the world arrays.
+	b2Transform& Transform();		// the body origin transform
+	const b2Transform& Transform() const;
+	b2Sweep& Sweep();				// the swept motion for CCD
+	const b2Sweep& Sweep() const;
+	b2Vec2& LinearVelocity();
+	const b2Vec2& LinearVelocity() const;
+	float32& AngularVelocity();
+	float32 AngularVelocity() const;
+	b2Vec2& Force();
+	const b2Vec2& Force() const;
+	float32& Torque();
+	float32 Torque() const;
+	float32& InvMass();
+	float32 InvMass() const;
+	float32& InvI();				// inverse rotational inertia about the center of mass
+	float32 InvI() const;
+
+	// The members are ordered by access frequency. The simulation state lives
+	// in m_arrays at m_worldIndex, the rest is read by the solver and the
+	// synchronization loops first and cold data comes last.
+
+	b2BodyArrays* m_arrays;
+
+	// Index in the world body array and the state arrays.
+	int32 m_worldIndex;
+
 	b2BodyType m_type;
 
 	uint16 m_flags;
 
 	int32 m_islandIndex;
 
-	b2Transform m_xf;		// the body origin transform
-	b2Sweep m_sweep;		// the swept motion for CCD
-
-	b2Vec2 m_linearVelocity;
-	float32 m_angularVelocity;
+	float32 m_mass;
 
-	b2Vec2 m_force;
-	float32 m_torque;
+	// Rotational inertia about the center of mass.
+	float32 m_I;
 
-	b2World* m_world;
-	b2Body* m_prev;
-	b2Body* m_next;
+	float32 m_linearDamping;
+	float32 m_angularDamping;
+	float32 m_gravityScale;
 
-	b2Fixture* m_fixtureList;
-	int32 m_fixtureCount;
+	float32 m_sleepTime;
 
+	// Graph state used to build islands and find contacts.
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
 
-	float32 m_mass, m_invMass;
+	b2Fixture* m_fixtureList;
+	int32 m_fixtureCount;
 
-	// Rotational inertia about the center of mass.
-	float32 m_I, m_invI;
+	// Head of the list of non-touching broad-phase pairs, see b2ContactPair.
+	int32 m_pairList;
 
-	float32 m_linearDamping;
-	float32 m_angularDamping;
-	float32 m_gravityScale;
+	// Number of collision ignore pairs that reference this body.
+	int32 m_bodyPairCount;
 
-	float32 m_sleepTime;
+	b2BodyId m_id;
+
+	b2World* m_world;
+	b2Body* m_prev;
+	b2Body* m_next;
 
 	void* m_userData;
 };
@@ -480,27 +538,27 @@ inline b2BodyType b2Body::GetType() const
 
 inline const b2Transform& b2Body::GetTransform() const
 {
-	return m_xf;
+	return Transform();
 }
 
 inline const b2Vec2& b2Body::GetPosition() const
 {
-	return m_xf.p;
+	return Transform().p;
 }
 
 inline float32 b2Body::GetAngle() const
 {
-	return m_sweep.a;
+	return Sweep().a;
 }
 
 inline const b2Vec2& b2Body::GetWorldCenter() const
 {
-	return m_sweep.c;
+	return Sweep().c;
 }
 
 inline const b2Vec2& b2Body::GetLocalCenter() const
 {
-	return m_sweep.localCenter;
+	return Sweep().localCenter;
 }
 
 inline void b2Body::SetLinearVelocity(const b2Vec2& v)
@@ -515,12 +573,12 @@ inline void b2Body::SetLinearVelocity(const b2Vec2& v)
 		SetAwake(true);
 	}
 
-	m_linearVelocity = v;
+	LinearVelocity() = v;
 }
 
 inline const b2Vec2& b2Body::GetLinearVelocity() const
 {
-	return m_linearVelocity;
+	return LinearVelocity();
 }
 
 inline void b2Body::SetAngularVelocity(float32 w)
@@ -535,12 +593,12 @@ inline void b2Body::SetAngularVelocity(float32 w)
 		SetAwake(true);
 	}
 
-	m_angularVelocity = w;
+	AngularVelocity() = w;
 }
 
 inline float32 b2Body::GetAngularVelocity() const
 {
-	return m_angularVelocity;
+	return AngularVelocity();
 }
 
 inline float32 b2Body::GetMass() const
@@ -550,39 +608,39 @@ inline float32 b2Body::GetMass() const
 
 inline float32 b2Body::GetInertia() const
 {
-	return m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
+	return m_I + m_mass * b2Dot(Sweep().localCenter, Sweep().localCenter);
 }
 
 inline void b2Body::GetMassData(b2MassData* data) const
 {
 	data->mass = m_mass;
-	data->I = m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
-	data->center = m_sweep.localCenter;
+	data->I = m_I + m_mass * b2Dot(Sweep().localCenter, Sweep().localCenter);
+	data->center = Sweep().localCenter;
 }
 
 inline b2Vec2 b2Body::GetWorldPoint(const b2Vec2& localPoint) const
 {
-	return b2Mul(m_xf, localPoint);
+	return b2Mul(Transform(), localPoint);
 }
 
 inline b2Vec2 b2Body::GetWorldVector(const b2Vec2& localVector) const
 {
-	return b2Mul(m_xf.q, localVector);
+	return b2Mul(Transform().q, localVector);
 }
 
 inline b2Vec2 b2Body::GetLocalPoint(const b2Vec2& worldPoint) const
 {
-	return b2MulT(m_xf, worldPoint);
+	return b2MulT(Transform(), worldPoint);
 }
 
 inline b2Vec2 b2Body::GetLocalVector(const b2Vec2& worldVector) const
 {
-	return b2MulT(m_xf.q, worldVector);
+	return b2MulT(Transform().q, worldVector);
 }
 
 inline b2Vec2 b2Body::GetLinearVelocityFromWorldPoint(const b2Vec2& worldPoint) const
 {
-	return m_linearVelocity + b2Cross(m_angularVelocity, worldPoint - m_sweep.c);
+	return LinearVelocity() + b2Cross(AngularVelocity(), worldPoint - Sweep().c);
 }
 
 inline b2Vec2 b2Body::GetLinearVelocityFromLocalPoint(const b2Vec2& localPoint) const
@@ -651,10 +709,10 @@ inline void b2Body::SetAwake(bool flag)
 	{
 		m_flags &= ~e_awakeFlag;
 		m_sleepTime = 0.0f;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_force.SetZero();
-		m_torque = 0.0f;
+		LinearVelocity().SetZero();
+		AngularVelocity() = 0.0f;
+		Force().SetZero();
+		Torque() = 0.0f;
 	}
 }
 
@@ -736,6 +794,11 @@ inline void b2Body::SetUserData(void* data)
 	m_userData = data;
 }
 
+inline b2BodyId b2Body::GetId() const
+{
+	return m_id;
+}
+
 inline void* b2Body::GetUserData() const
 {
 	return m_userData;
@@ -756,8 +819,8 @@ inline void b2Body::ApplyForce(const b2Vec2& force, const b2Vec2& point, bool wa
 	// Don't accumulate a force if the body is sleeping.
 	if (m_flags & e_awakeFlag)
 	{
-		m_force += force;
-		m_torque += b2Cross(point - m_sweep.c, force);
+		Force() += force;
+		Torque() += b2Cross(point - Sweep().c, force);
 	}
 }
 
@@ -776,7 +839,7 @@ inline void b2Body::ApplyForceToCenter(const b2Vec2& force, bool wake)
 	// Don't accumulate a force if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_force += force;
+		Force() += force;
 	}
 }
 
@@ -795,7 +858,7 @@ inline void b2Body::ApplyTorque(float32 torque, bool wake)
 	// Don't accumulate a force if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_torque += torque;
+		Torque() += torque;
 	}
 }
 
@@ -814,8 +877,8 @@ inline void b2Body::ApplyLinearImpulse(const b2Vec2& impulse, const b2Vec2& poin
 	// Don't accumulate velocity if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_linearVelocity += m_invMass * impulse;
-		m_angularVelocity += m_invI * b2Cross(point - m_sweep.c, impulse);
+		LinearVelocity() += InvMass() * impulse;
+		AngularVelocity() += InvI() * b2Cross(point - Sweep().c, impulse);
 	}
 }
 
@@ -834,7 +897,7 @@ inline void b2Body::ApplyLinearImpulseToCenter(const b2Vec2& impulse, bool wake)
 	// Don't accumulate velocity if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_linearVelocity += m_invMass * impulse;
+		LinearVelocity() += InvMass() * impulse;
 	}
 }
 
@@ -853,24 +916,28 @@ inline void b2Body::ApplyAngularImpulse(float32 impulse, bool wake)
 	// Don't accumulate velocity if the body is sleeping
 	if (m_flags & e_awakeFlag)
 	{
-		m_angularVelocity += m_invI * impulse;
+		AngularVelocity() += InvI() * impulse;
 	}
 }
 
 inline void b2Body::SynchronizeTransform()
 {
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	const b2Sweep& sweep = Sweep();
+	b2Transform& xf = Transform();
+	xf.q.Set(sweep.a);
+	xf.p = sweep.c - b2Mul(xf.q, sweep.localCenter);
 }
 
 inline void b2Body::Advance(float32 alpha)
 {
 	// Advance to the new safe time. This doesn't sync the broad-phase.
-	m_sweep.Advance(alpha);
-	m_sweep.c = m_sweep.c0;
-	m_sweep.a = m_sweep.a0;
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	b2Sweep& sweep = Sweep();
+	sweep.Advance(alpha);
+	sweep.c = sweep.c0;
+	sweep.a = sweep.a0;
+	b2Transform& xf = Transform();
+	xf.q.Set(sweep.a);
+	xf.p = sweep.c - b2Mul(xf.q, sweep.localCenter);
 }
 
 inline b2World* b2Body::GetWorld()
@@ -883,4 +950,84 @@ inline const b2World* b2Body::GetWorld() const
 	return m_world;
 }
 
+inline b2Transform& b2Body::Transform()
+{
+	return m_arrays->transforms[m_worldIndex];
+}
+
+inline const b2Transform& b2Body::Transform() const
+{
+	return m_arrays->transforms[m_worldIndex];
+}
+
+inline b2Sweep& b2Body::Sweep()
+{
+	return m_arrays->sweeps[m_worldIndex];
+}
+
+inline const b2Sweep& b2Body::Sweep() const
+{
+	return m_arrays->sweeps[m_worldIndex];
+}
+
+inline b2Vec2& b2Body::LinearVelocity()
+{
+	return m_arrays->linearVelocities[m_worldIndex];
+}
+
+inline const b2Vec2& b2Body::LinearVelocity() const
+{
+	return m_arrays->linearVelocities[m_worldIndex];
+}
+
+inline float32& b2Body::AngularVelocity()
+{
+	return m_arrays->angularVelocities[m_worldIndex];
+}
+
+inline float32 b2Body::AngularVelocity() const
+{
+	return m_arrays->angularVelocities[m_worldIndex];
+}
+
+inline b2Vec2& b2Body::Force()
+{
+	return m_arrays->forces[m_worldIndex];
+}
+
+inline const b2Vec2& b2Body::Force() const
+{
+	return m_arrays->forces[m_worldIndex];
+}
+
+inline float32& b2Body::Torque()
+{
+	return m_arrays->torques[m_worldIndex];
+}
+
+inline float32 b2Body::Torque() const
+{
+	return m_arrays->torques[m_worldIndex];
+}
+
+inline float32& b2Body::InvMass()
+{
+	return m_arrays->invMasses[m_worldIndex];
+}
+
+inline float32 b2Body::InvMass() const
+{
+	return m_arrays->invMasses[m_worldIndex];
+}
+
+inline float32& b2Body::InvI()
+{
+	return m_arrays->invIs[m_worldIndex];
+}
+
+inline float32 b2Body::InvI() const
+{
+	return m_arrays->invIs[m_worldIndex];
+}
+
 #endif
@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Dynamics/b2BodyPairSet.h"
+#include "Box2D/Dynamics/b2Body.h"
+#include <string.h>
+
+// Hash the pair addresses. The low bits are dropped because of alignment.
+static inline uint32 b2HashBodyPair(const b2Body* bodyA, const b2Body* bodyB)
+{
+	uint32 a = uint32(size_t(bodyA) >> 3);
+	uint32 b = uint32(size_t(bodyB) >> 3);
+	uint32 h = a * 0x9E3779B1u ^ b * 0x85EBCA6Bu;
+	return h ^ (h >> 16);
+}
+
+b2BodyPairSet::b2BodyPairSet(const b2Allocator* allocator)
+{
+	if (allocator)
+	{
+		m_allocator = *allocator;
+	}
+
+	// The table is allocated on first use.
+	m_pairs = nullptr;
+	m_capacity = 0;
+	m_count = 0;
+}
+
+b2BodyPairSet::~b2BodyPairSet()
+{
+	m_allocator.Free(m_pairs);
+}
+
+// Returns the slot of the pair or the empty slot where it would go,
+// -1 if the table is not allocated.
+int32 b2BodyPairSet::Find(const b2Body* bodyA, const b2Body* bodyB) const
+{
+	b2Assert(m_capacity > 0);
+	if (m_capacity == 0)
+	{
+		return -1;
+	}
+
+	int32 mask = m_capacity - 1;
+	int32 index = int32(b2HashBodyPair(bodyA, bodyB) & mask);
+	while (m_pairs[index].bodyA != nullptr)
+	{
+		if (m_pairs[index].bodyA == bodyA && m_pairs[index].bodyB == bodyB)
+		{
+			break;
+		}
+
+		index = (index + 1) & mask;
+	}
+
+	return index;
+}
+
+void b2BodyPairSet::Grow()
+{
+	b2BodyPair* oldPairs = m_pairs;
+	int32 oldCapacity = m_capacity;
+
+	m_capacity = m_capacity > 0 ? 2 * m_capacity : 16;
+	m_pairs = (b2BodyPair*)m_allocator.Allocate(m_capacity * sizeof(b2BodyPair));
+	memset(m_pairs, 0, m_capacity * sizeof(b2BodyPair));
+
+	for (int32 i = 0; i < oldCapacity; ++i)
+	{
+		const b2BodyPair& pair = oldPairs[i];
+		if (pair.bodyA != nullptr)
+		{
+			m_pairs[Find(pair.bodyA, pair.bodyB)] = pair;
+		}
+	}
+
+	m_allocator.Free(oldPairs);
+}
+
+void b2BodyPairSet::Add(b2Body* bodyA, b2Body* bodyB)
+{
+	b2Assert(bodyA != bodyB);
+	if (bodyB < bodyA)
+	{
+		b2Swap(bodyA, bodyB);
+	}
+
+	// Keep the load factor at or below one half.
+	if (2 * (m_count + 1) > m_capacity)
+	{
+		Grow();
+	}
+
+	int32 index = Find(bodyA, bodyB);
+	b2BodyPair* pair = m_pairs + index;
+	if (pair->bodyA != nullptr)
+	{
+		++pair->count;
+		return;
+	}
+
+	pair->bodyA = bodyA;
+	pair->bodyB = bodyB;
+	pair->count = 1;
+	++m_count;
+
+	++bodyA->m_bodyPairCount;
+	++bodyB->m_bodyPairCount;
+}
+
+void b2BodyPairSet::Remove(b2Body* bodyA, b2Body* bodyB)
+{
+	if (bodyB < bodyA)
+	{
+		b2Swap(bodyA, bodyB);
+	}
+
+	// A missing pair is ignored, so release builds keep the table intact.
+	int32 index = Find(bodyA, bodyB);
+	b2Assert(index != -1);
+	if (index == -1)
+	{
+		return;
+	}
+
+	b2BodyPair* pair = m_pairs + index;
+	b2Assert(pair->bodyA == bodyA && pair->count > 0);
+	if (pair->bodyA != bodyA)
+	{
+		return;
+	}
+
+	--pair->count;
+	if (pair->count == 0)
+	{
+		RemoveAt(index);
+	}
+}
+
+// Remove the pair in this slot and shift the following entries of the
+// probe sequence back so that no tombstones are needed.
+void b2BodyPairSet::RemoveAt(int32 index)
+{
+	b2BodyPair* pair = m_pairs + index;
+	--pair->bodyA->m_bodyPairCount;
+	--pair->bodyB->m_bodyPairCount;
+	pair->bodyA = nullptr;
+	pair->bodyB = nullptr;
+	--m_count;
+
+	int32 mask = m_capacity - 1;
+	int32 i = index;
+	int32 j = index;
+	for (;;)
+	{
+		j = (j + 1) & mask;
+		if (m_pairs[j].bodyA == nullptr)
+		{
+			break;
+		}
+
+		// The entry can move to the hole unless its home slot lies cyclically in (i, j].
+		int32 k = int32(b2HashBodyPair(m_pairs[j].bodyA, m_pairs[j].bodyB) & mask);
+		bool stay = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+		if (stay)
+		{
+			continue;
+		}
+
+		m_pairs[i] = m_pairs[j];
+		m_pairs[j].bodyA = nullptr;
+		m_pairs[j].bodyB = nullptr;
+		i = j;
+	}
+}
+
+void b2BodyPairSet::RemoveBody(b2Body* body)
+{
+	// A removal may shift an entry back into the current slot, so the
+	// slot is checked again before moving on.
+	int32 i = 0;
+	while (body->m_bodyPairCount > 0 && i < m_capacity)
+	{
+		const b2BodyPair& pair = m_pairs[i];
+		if (pair.bodyA != nullptr && (pair.bodyA == body || pair.bodyB == body))
+		{
+			RemoveAt(i);
+			continue;
+		}
+
+		++i;
+	}
+
+	b2Assert(body->m_bodyPairCount == 0);
+}
+
+void b2BodyPairSet::RelocateBody(b2Body* oldBody, b2Body* newBody)
+{
+	// The new body is a copy of the old one, so its pair count starts over.
+	newBody->m_bodyPairCount = 0;
+
+	// A removal can shift an entry back into an earlier slot when the probe
+	// sequence wraps, so the scan wraps as well until every pair has moved.
+	int32 mask = m_capacity - 1;
+	int32 i = 0;
+	while (oldBody->m_bodyPairCount > 0)
+	{
+		b2BodyPair pair = m_pairs[i];
+		if (pair.bodyA != nullptr && (pair.bodyA == oldBody || pair.bodyB == oldBody))
+		{
+			b2Body* other = pair.bodyA == oldBody ? pair.bodyB : pair.bodyA;
+			RemoveAt(i);
+			Add(newBody, other);
+
+			b2Body* bodyA = newBody;
+			b2Body* bodyB = other;
+			if (bodyB < bodyA)
+			{
+				b2Swap(bodyA, bodyB);
+			}
+			m_pairs[Find(bodyA, bodyB)].count = pair.count;
+			continue;
+		}
+
+		i = (i + 1) & mask;
+	}
+}
+
+bool b2BodyPairSet::Contains(const b2Body* bodyA, const b2Body* bodyB) const
+{
+	if (m_count == 0)
+	{
+		return false;
+	}
+
+	if (bodyB < bodyA)
+	{
+		b2Swap(bodyA, bodyB);
+	}
+
+	int32 index = Find(bodyA, bodyB);
+	return m_pairs[index].bodyA != nullptr;
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BODY_PAIR_SET_H
+#define B2_BODY_PAIR_SET_H
+
+#include "Box2D/Common/b2Settings.h"
+
+class b2Body;
+
+/// This is an internal structure.
+struct b2BodyPair
+{
+	b2Body* bodyA;	// the lower address, nullptr for an empty slot
+	b2Body* bodyB;
+	int32 count;
+};
+
+// A reference counted set of body pairs. This is an open addressing hash table
+// with linear probing. Each body counts the pairs that reference it so the
+// common case of a body without pairs never touches the table.
+class b2BodyPairSet
+{
+public:
+	b2BodyPairSet(const b2Allocator* allocator = nullptr);
+	~b2BodyPairSet();
+
+	// Add a reference to the pair.
+	void Add(b2Body* bodyA, b2Body* bodyB);
+
+	// Remove a reference to the pair. The pair must exist.
+	void Remove(b2Body* bodyA, b2Body* bodyB);
+
+	// Remove every pair that references this body.
+	void RemoveBody(b2Body* body);
+
+	// Replace a body that was moved by world compaction. The pairs are hashed
+	// by address, so they are removed and added again with their counts.
+	void RelocateBody(b2Body* oldBody, b2Body* newBody);
+
+	// Does the pair exist?
+	bool Contains(const b2Body* bodyA, const b2Body* bodyB) const;
+
+	// Get the number of distinct pairs.
+	int32 GetCount() const;
+
+private:
+
+	int32 Find(const b2Body* bodyA, const b2Body* bodyB) const;
+	void RemoveAt(int32 index);
+	void Grow();
+
+	b2Allocator m_allocator;
+	b2BodyPair* m_pairs;
+	int32 m_capacity;
+	int32 m_count;
+};
+
+inline int32 b2BodyPairSet::GetCount() const
+{
+	return m_count;
+}
+
+#endif
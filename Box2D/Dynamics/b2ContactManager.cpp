@@ -21,17 +21,173 @@
 #include "Box2D/Dynamics/b2Fixture.h"
 #include "Box2D/Dynamics/b2WorldCallbacks.h"
 #include "Box2D/Dynamics/Contacts/b2Contact.h"
+#include "Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h"
+#include "Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h"
+#include "Box2D/Dynamics/Contacts/b2CircleContact.h"
+#include "Box2D/Dynamics/Contacts/b2EdgeAndCircleContact.h"
+#include "Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h"
+#include "Box2D/Dynamics/Contacts/b2PolygonAndCircleContact.h"
+#include "Box2D/Dynamics/Contacts/b2PolygonContact.h"
+
+#include <algorithm>
+#include <string.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
-b2ContactManager::b2ContactManager()
+// Get the links of a pair in the pair list of one of its bodies.
+inline int32* b2GetPairPrev(b2ContactPair* pair, const b2Body* body)
+{
+	return pair->fixtureA->GetBody() == body ? &pair->prevA : &pair->prevB;
+}
+
+inline int32* b2GetPairNext(b2ContactPair* pair, const b2Body* body)
+{
+	return pair->fixtureA->GetBody() == body ? &pair->nextA : &pair->nextB;
+}
+
+// The slots of a contact array are filled from the back.
+inline bool b2SlotGreaterThan(const b2ContactSlot& slot1, const b2ContactSlot& slot2)
+{
+	return slot1.index > slot2.index;
+}
+
+// Get a new slot at the end of a buffer, growing the buffer as needed.
+template <typename T>
+static T* b2PushBack(T** items, int32* count, int32* capacity, const b2Allocator& allocator)
 {
+	if (*count == *capacity)
+	{
+		T* oldItems = *items;
+		*capacity = *capacity > 0 ? 2 * *capacity : 16;
+		*items = (T*)allocator.Allocate(*capacity * sizeof(T));
+		if (oldItems)
+		{
+			memcpy(*items, oldItems, *count * sizeof(T));
+			allocator.Free(oldItems);
+		}
+	}
+
+	T* item = *items + *count;
+	++(*count);
+	return item;
+}
+
+// Grow a buffer to hold at least this many items.
+template <typename T>
+static void b2Reserve(T** items, int32 count, int32* capacity, int32 newCapacity, const b2Allocator& allocator)
+{
+	if (newCapacity <= *capacity)
+	{
+		return;
+	}
+
+	T* oldItems = *items;
+	*capacity = newCapacity;
+	*items = (T*)allocator.Allocate(*capacity * sizeof(T));
+	if (oldItems)
+	{
+		memcpy(*items, oldItems, count * sizeof(T));
+		allocator.Free(oldItems);
+	}
+}
+
+b2ContactManager::b2ContactManager(const b2Allocator* allocator)
+	: m_broadPhase(allocator)
+	, m_sensorManager(allocator)
+	, m_contactIds(allocator)
+{
+	if (allocator)
+	{
+		m_arrayAllocator = *allocator;
+	}
+
 	m_contactList = nullptr;
+	memset(m_contactArrays, 0, sizeof(m_contactArrays));
 	m_contactCount = 0;
+	m_freeSlots = nullptr;
+	m_freeSlotCount = 0;
+	m_freeSlotCapacity = 0;
+	m_pairs = nullptr;
+	m_pairCount = 0;
+	m_pairCapacity = 0;
 	m_contactFilter = &b2_defaultFilter;
+	m_contactFilterFcn = nullptr;
+	m_contactFilterContext = nullptr;
+	memset(m_layerMatrix, 0, sizeof(m_layerMatrix));
+	m_filterMode = e_defaultFilter;
 	m_contactListener = &b2_defaultListener;
-	m_allocator = nullptr;
+	m_relocationListener = nullptr;
+
+	// The event buffers are allocated on first use.
+	m_beginEvents = nullptr;
+	m_beginEventCount = 0;
+	m_beginEventCapacity = 0;
+
+	m_endEvents = nullptr;
+	m_endEventCount = 0;
+	m_endEventCapacity = 0;
+	m_stepEndEventCount = 0;
+
+	m_hitEvents = nullptr;
+	m_hitEventCount = 0;
+	m_hitEventCapacity = 0;
+
+	m_impulseEvents = nullptr;
+	m_impulseEventCount = 0;
+	m_impulseEventCapacity = 0;
+
+	m_hitEventThreshold = 1.0f;
+	m_impulseEventThreshold = 0.0f;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	// The contact destructors are trivial, so the contacts go away with the arrays.
+	for (int32 i = 0; i < e_arrayCount; ++i)
+	{
+		m_arrayAllocator.Free(m_contactArrays[i].contacts);
+	}
+
+	m_arrayAllocator.Free(m_freeSlots);
+	m_arrayAllocator.Free(m_pairs);
+	m_arrayAllocator.Free(m_beginEvents);
+	m_arrayAllocator.Free(m_endEvents);
+	m_arrayAllocator.Free(m_hitEvents);
+	m_arrayAllocator.Free(m_impulseEvents);
+}
+
+bool b2ContactManager::ShouldCollide(b2Fixture* fixtureA, b2Fixture* fixtureB) const
+{
+	if (m_filterMode == e_userFilter)
+	{
+		return m_contactFilter == nullptr || m_contactFilter->ShouldCollide(fixtureA, fixtureB);
+	}
+
+	// The built-in modes share the body tests of b2ContactFilter::ShouldCollide.
+	const b2Body* bodyA = fixtureA->m_body;
+	const b2Body* bodyB = fixtureB->m_body;
+	if (bodyA->m_type == b2_staticBody && bodyB->m_type == b2_staticBody)
+	{
+		return false;
+	}
+
+	if (bodyB->ShouldCollideConnected(bodyA) == false)
+	{
+		return false;
+	}
+
+	switch (m_filterMode)
+	{
+	case e_functionFilter:
+		return m_contactFilterFcn(fixtureA, fixtureB, m_contactFilterContext);
+
+	case e_layerFilter:
+		return ((m_layerMatrix[fixtureA->m_filter.layer] >> fixtureB->m_filter.layer) & 1) != 0;
+
+	default:
+		return b2TestFilter(fixtureA->m_filter, fixtureB->m_filter);
+	}
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -41,9 +197,14 @@ void b2ContactManager::Destroy(b2Contact* c)
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (m_contactListener && c->IsTouching())
+	if (c->IsTouching())
 	{
-		m_contactListener->EndContact(c);
+		if (m_contactListener)
+		{
+			m_contactListener->EndContact(c);
+		}
+
+		ReportEndTouch(c);
 	}
 
 	// Remove from the world.
@@ -94,9 +255,18 @@ void b2ContactManager::Destroy(b2Contact* c)
 		bodyB->m_contactList = c->m_nodeB.next;
 	}
 
-	// Call the factory.
-	b2Contact::Destroy(c, m_allocator);
+	m_contactIds.Destroy(c->m_id);
+
+	// The slot is filled by ReleaseContacts, so the contact arrays keep their
+	// order while callers walk them.
+	b2ContactSlot* slot = b2PushBack(&m_freeSlots, &m_freeSlotCount, &m_freeSlotCapacity, m_arrayAllocator);
+	slot->arrayIndex = b2Contact::GetArrayIndex(fixtureA->GetType(), fixtureB->GetType());
+	slot->index = c->m_managerIndex;
+	b2Assert(m_contactArrays[slot->arrayIndex].GetContact(slot->index) == c);
 	--m_contactCount;
+
+	// Call the factory.
+	b2Contact::Destroy(c);
 }
 
 // This is the top level collision call for the time step. Here
@@ -104,31 +274,85 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
-	// Update awake contacts.
-	b2Contact* c = m_contactList;
-	while (c)
-	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
-		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
+	// Update awake contacts, one shape type pair at a time.
+	for (int32 arrayIndex = 0; arrayIndex < e_arrayCount; ++arrayIndex)
+	{
+		const b2ContactArray* array = m_contactArrays + arrayIndex;
+		for (int32 i = 0; i < array->count; ++i)
+		{
+			b2Contact* c = array->GetContact(i);
+			b2Fixture* fixtureA = c->GetFixtureA();
+			b2Fixture* fixtureB = c->GetFixtureB();
+			int32 indexA = c->GetChildIndexA();
+			int32 indexB = c->GetChildIndexB();
+			b2Body* bodyA = fixtureA->GetBody();
+			b2Body* bodyB = fixtureB->GetBody();
+
+			// Is this contact flagged for filtering?
+			if (c->m_flags & b2Contact::e_filterFlag)
+			{
+				// Check user filtering.
+				if (ShouldCollide(fixtureA, fixtureB) == false)
+				{
+					Destroy(c);
+					continue;
+				}
+
+				// Clear the filtering flag.
+				c->m_flags &= ~b2Contact::e_filterFlag;
+			}
+
+			bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+			bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+
+			// At least one body must be awake and it must be dynamic or kinematic.
+			if (activeA == false && activeB == false)
+			{
+				continue;
+			}
+
+			int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+			int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+			bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+			// Here we destroy contacts that cease to overlap in the broad-phase.
+			if (overlap == false)
+			{
+				Destroy(c);
+				continue;
+			}
+
+			// The contact persists.
+			c->Update(this);
+		}
+	}
+
+	// Destroyed contacts leave holes in the arrays until the update loop is done.
+	ReleaseContacts();
+
+	// Update the pairs. A destroyed pair is replaced by the last pair, so the
+	// index only advances when the pair is kept.
+	int32 i = 0;
+	while (i < m_pairCount)
+	{
+		b2ContactPair* pair = m_pairs + i;
+		b2Fixture* fixtureA = pair->fixtureA;
+		b2Fixture* fixtureB = pair->fixtureB;
+		int32 indexA = pair->indexA;
+		int32 indexB = pair->indexB;
+		b2Body* bodyA = fixtureA->m_body;
+		b2Body* bodyB = fixtureB->m_body;
+
+		// Is this pair flagged for filtering?
+		if (pair->flags & b2ContactPair::e_filterFlag)
 		{
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			if (ShouldCollide(fixtureA, fixtureB) == false)
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
+				DestroyPair(i);
 				continue;
 			}
 
-			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
+			pair->flags &= ~b2ContactPair::e_filterFlag;
 		}
 
 		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
@@ -137,7 +361,7 @@ void b2ContactManager::Collide()
 		// At least one body must be awake and it must be dynamic or kinematic.
 		if (activeA == false && activeB == false)
 		{
-			c = c->GetNext();
+			++i;
 			continue;
 		}
 
@@ -145,19 +369,243 @@ void b2ContactManager::Collide()
 		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
 		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
+		// Here we destroy pairs that cease to overlap in the broad-phase.
 		if (overlap == false)
 		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
+			DestroyPair(i);
 			continue;
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+		// A bullet flag may have been set since the pair was created.
+		if (NeedsContact(bodyA, bodyB) == false)
+		{
+			bool touching = b2TestOverlap(fixtureA->m_shape, indexA, fixtureB->m_shape, indexB,
+										  bodyA->Transform(), bodyB->Transform());
+			if (touching == false)
+			{
+				++i;
+				continue;
+			}
+		}
+
+		// Promote the pair to a contact.
+		DestroyPair(i);
+		b2Contact* c = CreateContact(fixtureA, indexA, fixtureB, indexB);
+		if (c)
+		{
+			c->Update(this);
+		}
+	}
+}
+
+void b2ContactManager::Reserve(int32 contactCount)
+{
+	b2Reserve(&m_freeSlots, m_freeSlotCount, &m_freeSlotCapacity, contactCount, m_arrayAllocator);
+	b2Reserve(&m_pairs, m_pairCount, &m_pairCapacity, contactCount, m_arrayAllocator);
+	b2Reserve(&m_beginEvents, m_beginEventCount, &m_beginEventCapacity, contactCount, m_arrayAllocator);
+	b2Reserve(&m_endEvents, m_endEventCount, &m_endEventCapacity, contactCount, m_arrayAllocator);
+	b2Reserve(&m_hitEvents, m_hitEventCount, &m_hitEventCapacity, contactCount, m_arrayAllocator);
+	b2Reserve(&m_impulseEvents, m_impulseEventCount, &m_impulseEventCapacity, contactCount, m_arrayAllocator);
+	m_contactIds.Reserve(contactCount);
+}
+
+void b2ContactManager::ReserveContacts(int32 arrayIndex, int32 contactCount)
+{
+	b2Assert(0 <= arrayIndex && arrayIndex < e_arrayCount);
+	b2ContactArray* array = m_contactArrays + arrayIndex;
+	if (contactCount <= array->capacity)
+	{
+		return;
+	}
+
+	// Only live contacts can be moved.
+	ReleaseContacts();
+
+	char* oldContacts = array->contacts;
+	array->contacts = (char*)m_arrayAllocator.Allocate(contactCount * sizeof(b2Contact));
+	array->capacity = contactCount;
+
+	for (int32 i = 0; i < array->count; ++i)
+	{
+		MoveContact((b2Contact*)(oldContacts + i * sizeof(b2Contact)), array->GetContact(i));
+	}
+
+	m_arrayAllocator.Free(oldContacts);
+}
+
+void* b2ContactManager::AllocateContact(int32 arrayIndex)
+{
+	b2ContactArray* array = m_contactArrays + arrayIndex;
+	if (array->count == array->capacity)
+	{
+		ReserveContacts(arrayIndex, array->capacity > 0 ? 2 * array->capacity : 16);
+	}
+
+	void* mem = array->GetContact(array->count);
+	++array->count;
+	return mem;
+}
+
+void b2ContactManager::ReleaseContacts()
+{
+	// Fill the holes from the back, so the last contact of an array is never a hole
+	// when it is moved.
+	std::sort(m_freeSlots, m_freeSlots + m_freeSlotCount, b2SlotGreaterThan);
+
+	for (int32 i = 0; i < m_freeSlotCount; ++i)
+	{
+		const b2ContactSlot* slot = m_freeSlots + i;
+		b2ContactArray* array = m_contactArrays + slot->arrayIndex;
+		--array->count;
+		if (slot->index < array->count)
+		{
+			b2Contact* c = MoveContact(array->GetContact(array->count), array->GetContact(slot->index));
+			c->m_managerIndex = slot->index;
+		}
+	}
+
+	m_freeSlotCount = 0;
+}
+
+void b2ContactManager::AddContact(b2Contact* c)
+{
+	// Insert into the world.
+	c->m_prev = nullptr;
+	c->m_next = m_contactList;
+	if (m_contactList != nullptr)
+	{
+		m_contactList->m_prev = c;
+	}
+	m_contactList = c;
+
+	++m_contactCount;
+}
+
+void b2ContactManager::ReportBeginTouch(b2Contact* c)
+{
+	b2Fixture* fixtureA = c->m_fixtureA;
+	b2Fixture* fixtureB = c->m_fixtureB;
+	bool contactEvents = fixtureA->m_enableContactEvents || fixtureB->m_enableContactEvents;
+	bool hitEvents = fixtureA->m_enableHitEvents || fixtureB->m_enableHitEvents;
+	if (contactEvents == false && hitEvents == false)
+	{
+		return;
+	}
+
+	b2WorldManifold worldManifold;
+	c->GetWorldManifold(&worldManifold);
+	int32 pointCount = c->m_manifold.pointCount;
+
+	if (contactEvents)
+	{
+		b2ContactBeginTouchEvent* event = b2PushBack(&m_beginEvents, &m_beginEventCount, &m_beginEventCapacity, m_arrayAllocator);
+		event->fixtureA = fixtureA;
+		event->fixtureB = fixtureB;
+		event->fixtureIdA = fixtureA->m_id;
+		event->fixtureIdB = fixtureB->m_id;
+		c->m_flags |= b2Contact::e_beginEventFlag;
+		event->childIndexA = c->m_indexA;
+		event->childIndexB = c->m_indexB;
+		event->worldManifold = worldManifold;
+		event->pointCount = pointCount;
+	}
+
+	if (hitEvents)
+	{
+		b2Body* bodyA = fixtureA->m_body;
+		b2Body* bodyB = fixtureB->m_body;
+		b2Vec2 vA = bodyA->LinearVelocity();
+		float32 wA = bodyA->AngularVelocity();
+		b2Vec2 vB = bodyB->LinearVelocity();
+		float32 wB = bodyB->AngularVelocity();
+
+		// Find the point with the largest approach speed.
+		float32 approachSpeed = -b2_maxFloat;
+		b2Vec2 point = b2Vec2_zero;
+		for (int32 i = 0; i < pointCount; ++i)
+		{
+			b2Vec2 rA = worldManifold.points[i] - bodyA->Sweep().c;
+			b2Vec2 rB = worldManifold.points[i] - bodyB->Sweep().c;
+			b2Vec2 dv = vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA);
+			float32 speed = -b2Dot(dv, worldManifold.normal);
+			if (speed > approachSpeed)
+			{
+				approachSpeed = speed;
+				point = worldManifold.points[i];
+			}
+		}
+
+		if (approachSpeed > m_hitEventThreshold)
+		{
+			b2ContactHitEvent* event = b2PushBack(&m_hitEvents, &m_hitEventCount, &m_hitEventCapacity, m_arrayAllocator);
+			event->fixtureA = fixtureA;
+			event->fixtureB = fixtureB;
+			event->point = point;
+			event->normal = worldManifold.normal;
+			event->approachSpeed = approachSpeed;
+		}
+	}
+}
+
+void b2ContactManager::ReportEndTouch(b2Contact* c)
+{
+	// Pair the begin event, even if the fixtures disabled contact events since.
+	if ((c->m_flags & b2Contact::e_beginEventFlag) == 0)
+	{
+		return;
+	}
+
+	c->m_flags &= ~b2Contact::e_beginEventFlag;
+
+	b2Fixture* fixtureA = c->m_fixtureA;
+	b2Fixture* fixtureB = c->m_fixtureB;
+	b2ContactEndTouchEvent* event = b2PushBack(&m_endEvents, &m_endEventCount, &m_endEventCapacity, m_arrayAllocator);
+	event->fixtureA = fixtureA;
+	event->fixtureB = fixtureB;
+	event->fixtureIdA = fixtureA->m_id;
+	event->fixtureIdB = fixtureB->m_id;
+	event->childIndexA = c->m_indexA;
+	event->childIndexB = c->m_indexB;
+}
+
+void b2ContactManager::ReportImpulse(b2Contact* c, const b2ContactImpulse& impulse)
+{
+	b2WorldManifold worldManifold;
+	c->GetWorldManifold(&worldManifold);
+
+	b2ContactImpulseEvent* event = b2PushBack(&m_impulseEvents, &m_impulseEventCount, &m_impulseEventCapacity, m_arrayAllocator);
+	event->fixtureA = c->m_fixtureA;
+	event->fixtureB = c->m_fixtureB;
+	event->normal = worldManifold.normal;
+	event->impulse = impulse;
+
+	// Find the point with the largest normal impulse.
+	event->point = worldManifold.points[0];
+	event->maxNormalImpulse = impulse.normalImpulses[0];
+	for (int32 i = 1; i < impulse.count; ++i)
+	{
+		if (impulse.normalImpulses[i] > event->maxNormalImpulse)
+		{
+			event->point = worldManifold.points[i];
+			event->maxNormalImpulse = impulse.normalImpulses[i];
+		}
+	}
+}
+
+void b2ContactManager::ClearEvents()
+{
+	// Keep the end events of the contacts destroyed since the last time step.
+	int32 carriedCount = m_endEventCount - m_stepEndEventCount;
+	if (carriedCount > 0 && m_stepEndEventCount > 0)
+	{
+		memmove(m_endEvents, m_endEvents + m_stepEndEventCount, carriedCount * sizeof(b2ContactEndTouchEvent));
 	}
+	m_endEventCount = carriedCount;
+	m_stepEndEventCount = 0;
+
+	m_beginEventCount = 0;
+	m_hitEventCount = 0;
+	m_impulseEventCount = 0;
 }
 
 void b2ContactManager::FindNewContacts()
@@ -185,6 +633,29 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	// Sensors track their overlaps without contacts.
+	bool sensorA = fixtureA->IsSensor();
+	bool sensorB = fixtureB->IsSensor();
+	if (sensorA || sensorB)
+	{
+		// Sensors don't detect other sensors.
+		if (sensorA && sensorB)
+		{
+			return;
+		}
+
+		if (sensorA)
+		{
+			m_sensorManager.AddPair(proxyA, proxyB, this);
+		}
+		else
+		{
+			m_sensorManager.AddPair(proxyB, proxyA, this);
+		}
+
+		return;
+	}
+
 	// TODO_ERIN use a hash table to remove a potential bottleneck when both
 	// bodies have a lot of contacts.
 	// Does a contact already exist?
@@ -214,35 +685,64 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		edge = edge->next;
 	}
 
+	// Does a pair already exist?
+	for (int32 index = bodyB->m_pairList; index != b2_nullPair; index = *b2GetPairNext(m_pairs + index, bodyB))
+	{
+		const b2ContactPair* pair = m_pairs + index;
+		if (pair->fixtureA == fixtureA && pair->fixtureB == fixtureB && pair->indexA == indexA && pair->indexB == indexB)
+		{
+			return;
+		}
+
+		if (pair->fixtureA == fixtureB && pair->fixtureB == fixtureA && pair->indexA == indexB && pair->indexB == indexA)
+		{
+			return;
+		}
+	}
+
 	// Check user filtering.
-	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+	if (ShouldCollide(fixtureA, fixtureB) == false)
 	{
 		return;
 	}
 
-	// Call the factory.
-	b2Contact* c = b2Contact::Create(fixtureA, indexA, fixtureB, indexB, m_allocator);
-	if (c == nullptr)
+	// Shapes that only overlap in the broad-phase get a pair record. The pair
+	// is promoted to a contact when the shapes touch, see Collide.
+	if (NeedsContact(bodyA, bodyB))
 	{
-		return;
+		CreateContact(fixtureA, indexA, fixtureB, indexB);
+	}
+	else
+	{
+		CreatePair(fixtureA, indexA, fixtureB, indexB);
 	}
 
-	// Contact creation may swap fixtures.
-	fixtureA = c->GetFixtureA();
-	fixtureB = c->GetFixtureB();
-	indexA = c->GetChildIndexA();
-	indexB = c->GetChildIndexB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	// Wake up the bodies
+	bodyA->SetAwake(true);
+	bodyB->SetAwake(true);
+}
 
-	// Insert into the world.
-	c->m_prev = nullptr;
-	c->m_next = m_contactList;
-	if (m_contactList != nullptr)
+b2Contact* b2ContactManager::CreateContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
+	int32 arrayIndex = b2Contact::GetArrayIndex(fixtureA->GetType(), fixtureB->GetType());
+	if (arrayIndex == -1)
 	{
-		m_contactList->m_prev = c;
+		return nullptr;
 	}
-	m_contactList = c;
+
+	// Call the factory.
+	void* mem = AllocateContact(arrayIndex);
+	b2Contact* c = b2Contact::Create(fixtureA, indexA, fixtureB, indexB, mem);
+	c->m_managerIndex = m_contactArrays[arrayIndex].count - 1;
+
+	// Contact creation may swap fixtures.
+	b2Body* bodyA = c->GetFixtureA()->GetBody();
+	b2Body* bodyB = c->GetFixtureB()->GetBody();
+
+	c->m_id = m_contactIds.Create(c);
+
+	// Insert into the world.
+	AddContact(c);
 
 	// Connect to island graph.
 
@@ -270,12 +770,276 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	bodyB->m_contactList = &c->m_nodeB;
 
-	// Wake up the bodies
-	if (fixtureA->IsSensor() == false && fixtureB->IsSensor() == false)
+	return c;
+}
+
+bool b2ContactManager::NeedsContact(const b2Body* bodyA, const b2Body* bodyB) const
+{
+	// The TOI solver only looks at contacts, so pairs that take part in
+	// continuous collision skip the pair stage.
+	if (bodyA->m_type != b2_dynamicBody || bodyB->m_type != b2_dynamicBody)
 	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
+		return true;
 	}
 
-	++m_contactCount;
+	return bodyA->IsBullet() || bodyB->IsBullet();
+}
+
+void b2ContactManager::CreatePair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
+	int32 index = m_pairCount;
+	b2ContactPair* pair = b2PushBack(&m_pairs, &m_pairCount, &m_pairCapacity, m_arrayAllocator);
+	pair->fixtureA = fixtureA;
+	pair->fixtureB = fixtureB;
+	pair->indexA = indexA;
+	pair->indexB = indexB;
+	pair->flags = 0;
+
+	// Push on the pair lists of both bodies.
+	b2Body* bodyA = fixtureA->m_body;
+	pair->prevA = b2_nullPair;
+	pair->nextA = bodyA->m_pairList;
+	if (bodyA->m_pairList != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + bodyA->m_pairList, bodyA) = index;
+	}
+	bodyA->m_pairList = index;
+
+	b2Body* bodyB = fixtureB->m_body;
+	pair->prevB = b2_nullPair;
+	pair->nextB = bodyB->m_pairList;
+	if (bodyB->m_pairList != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + bodyB->m_pairList, bodyB) = index;
+	}
+	bodyB->m_pairList = index;
+}
+
+void b2ContactManager::DestroyPair(int32 index)
+{
+	b2Assert(0 <= index && index < m_pairCount);
+
+	// Remove from the pair lists of both bodies.
+	b2ContactPair* pair = m_pairs + index;
+	b2Body* bodyA = pair->fixtureA->m_body;
+	b2Body* bodyB = pair->fixtureB->m_body;
+
+	if (pair->prevA != b2_nullPair)
+	{
+		*b2GetPairNext(m_pairs + pair->prevA, bodyA) = pair->nextA;
+	}
+	else
+	{
+		bodyA->m_pairList = pair->nextA;
+	}
+
+	if (pair->nextA != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + pair->nextA, bodyA) = pair->prevA;
+	}
+
+	if (pair->prevB != b2_nullPair)
+	{
+		*b2GetPairNext(m_pairs + pair->prevB, bodyB) = pair->nextB;
+	}
+	else
+	{
+		bodyB->m_pairList = pair->nextB;
+	}
+
+	if (pair->nextB != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + pair->nextB, bodyB) = pair->prevB;
+	}
+
+	// Move the last pair into the hole and patch the links that refer to it.
+	--m_pairCount;
+	if (index == m_pairCount)
+	{
+		return;
+	}
+
+	*pair = m_pairs[m_pairCount];
+	bodyA = pair->fixtureA->m_body;
+	bodyB = pair->fixtureB->m_body;
+
+	if (pair->prevA != b2_nullPair)
+	{
+		*b2GetPairNext(m_pairs + pair->prevA, bodyA) = index;
+	}
+	else
+	{
+		bodyA->m_pairList = index;
+	}
+
+	if (pair->nextA != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + pair->nextA, bodyA) = index;
+	}
+
+	if (pair->prevB != b2_nullPair)
+	{
+		*b2GetPairNext(m_pairs + pair->prevB, bodyB) = index;
+	}
+	else
+	{
+		bodyB->m_pairList = index;
+	}
+
+	if (pair->nextB != b2_nullPair)
+	{
+		*b2GetPairPrev(m_pairs + pair->nextB, bodyB) = index;
+	}
+}
+
+void b2ContactManager::DestroyPairs(b2Body* body, const b2Fixture* fixture)
+{
+	int32 index = body->m_pairList;
+	while (index != b2_nullPair)
+	{
+		b2ContactPair* pair = m_pairs + index;
+		int32 next = *b2GetPairNext(pair, body);
+
+		if (fixture == nullptr || pair->fixtureA == fixture || pair->fixtureB == fixture)
+		{
+			DestroyPair(index);
+
+			// The last pair was moved into the hole.
+			if (next == m_pairCount)
+			{
+				next = index;
+			}
+		}
+
+		index = next;
+	}
+}
+
+b2Contact* b2ContactManager::MoveContact(b2Contact* c, void* mem)
+{
+	// The contact types add no members to b2Contact, so they share the stride of
+	// the contact arrays and are moved as a b2Contact.
+	static_assert(sizeof(b2CircleContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2PolygonAndCircleContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2PolygonContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2EdgeAndCircleContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2EdgeAndPolygonContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2ChainAndCircleContact) == sizeof(b2Contact), "relocated contacts must fit");
+	static_assert(sizeof(b2ChainAndPolygonContact) == sizeof(b2Contact), "relocated contacts must fit");
+	memcpy(mem, (const void*)c, sizeof(b2Contact));
+	b2Contact* nc = (b2Contact*)mem;
+
+	// World list.
+	if (nc->m_prev)
+	{
+		nc->m_prev->m_next = nc;
+	}
+	else
+	{
+		m_contactList = nc;
+	}
+
+	if (nc->m_next)
+	{
+		nc->m_next->m_prev = nc;
+	}
+
+	m_contactIds.Set(nc->m_id, nc);
+
+	// Body A contact list.
+	nc->m_nodeA.contact = nc;
+	if (nc->m_nodeA.prev)
+	{
+		nc->m_nodeA.prev->next = &nc->m_nodeA;
+	}
+	else
+	{
+		nc->m_fixtureA->m_body->m_contactList = &nc->m_nodeA;
+	}
+
+	if (nc->m_nodeA.next)
+	{
+		nc->m_nodeA.next->prev = &nc->m_nodeA;
+	}
+
+	// Body B contact list.
+	nc->m_nodeB.contact = nc;
+	if (nc->m_nodeB.prev)
+	{
+		nc->m_nodeB.prev->next = &nc->m_nodeB;
+	}
+	else
+	{
+		nc->m_fixtureB->m_body->m_contactList = &nc->m_nodeB;
+	}
+
+	if (nc->m_nodeB.next)
+	{
+		nc->m_nodeB.next->prev = &nc->m_nodeB;
+	}
+
+	if (m_relocationListener)
+	{
+		m_relocationListener->ContactMoved(c, nc);
+	}
+
+	return nc;
+}
+
+void b2ContactManager::RelocateFixture(b2Fixture* oldFixture, b2Fixture* newFixture)
+{
+	b2Body* body = newFixture->m_body;
+
+	for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+	{
+		b2Contact* c = ce->contact;
+		if (c->m_fixtureA == oldFixture)
+		{
+			c->m_fixtureA = newFixture;
+		}
+		else if (c->m_fixtureB == oldFixture)
+		{
+			c->m_fixtureB = newFixture;
+		}
+	}
+
+	for (int32 index = body->m_pairList; index != b2_nullPair; index = *b2GetPairNext(m_pairs + index, body))
+	{
+		b2ContactPair* pair = m_pairs + index;
+		if (pair->fixtureA == oldFixture)
+		{
+			pair->fixtureA = newFixture;
+		}
+		else if (pair->fixtureB == oldFixture)
+		{
+			pair->fixtureB = newFixture;
+		}
+	}
+
+	m_sensorManager.RelocateFixture(oldFixture, newFixture);
+}
+
+void b2ContactManager::FlagPairsForFiltering(const b2Fixture* fixture)
+{
+	b2Body* body = fixture->m_body;
+	for (int32 index = body->m_pairList; index != b2_nullPair; index = *b2GetPairNext(m_pairs + index, body))
+	{
+		b2ContactPair* pair = m_pairs + index;
+		if (pair->fixtureA == fixture || pair->fixtureB == fixture)
+		{
+			pair->flags |= b2ContactPair::e_filterFlag;
+		}
+	}
+}
+
+void b2ContactManager::FlagPairsForFiltering(const b2Body* bodyA, const b2Body* bodyB)
+{
+	for (int32 index = bodyB->m_pairList; index != b2_nullPair; index = *b2GetPairNext(m_pairs + index, bodyB))
+	{
+		b2ContactPair* pair = m_pairs + index;
+		if (pair->fixtureA->m_body == bodyA || pair->fixtureB->m_body == bodyA)
+		{
+			pair->flags |= b2ContactPair::e_filterFlag;
+		}
+	}
 }
@@ -20,17 +20,141 @@
 #define B2_CONTACT_MANAGER_H
 
 #include "Box2D/Collision/b2BroadPhase.h"
+#include "Box2D/Common/b2HandleTable.h"
+#include "Box2D/Dynamics/b2SensorManager.h"
+#include "Box2D/Dynamics/b2WorldCallbacks.h"
+#include "Box2D/Dynamics/Contacts/b2Contact.h"
 
-class b2Contact;
+class b2Body;
 class b2ContactFilter;
 class b2ContactListener;
-class b2BlockAllocator;
+class b2Fixture;
+class b2RelocationListener;
+
+/// A begin touch event is buffered when a contact starts touching and either
+/// fixture has contact events enabled. The fixture pointers are not valid after
+/// the fixture is destroyed, use the ids with b2World::GetFixture to check.
+struct b2ContactBeginTouchEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixtureId fixtureIdA;
+	b2FixtureId fixtureIdB;
+	int32 childIndexA;
+	int32 childIndexB;
+	b2WorldManifold worldManifold;
+	int32 pointCount;
+};
+
+/// An end touch event is buffered when a contact that had a begin touch event stops
+/// touching or is destroyed, even if the contact events were disabled since. Events of
+/// contacts destroyed between time steps are reported with the next time step, with a
+/// null pointer for a fixture that was destroyed. Until then their pointers to destroyed
+/// fixtures are not valid, use the ids with b2World::GetFixture to check.
+struct b2ContactEndTouchEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixtureId fixtureIdA;
+	b2FixtureId fixtureIdB;
+	int32 childIndexA;
+	int32 childIndexB;
+};
+
+/// A hit event is buffered when a contact starts touching with an approach speed
+/// above the world hit event threshold and either fixture has hit events enabled.
+struct b2ContactHitEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2Vec2 point;			///< world point with the largest approach speed
+	b2Vec2 normal;			///< world vector pointing from A to B
+	float32 approachSpeed;	///< relative normal velocity, positive when approaching
+};
+
+/// An impulse event is buffered after the solver for contacts of fixtures with impulse
+/// events enabled when the largest normal impulse reaches the world impulse threshold.
+struct b2ContactImpulseEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2Vec2 point;				///< world point with the largest normal impulse
+	b2Vec2 normal;				///< world vector pointing from A to B
+	float32 maxNormalImpulse;	///< the largest normal impulse
+	b2ContactImpulse impulse;	///< the impulses of all the manifold points
+};
+
+#define b2_nullPair (-1)
+
+/// This is an internal structure. A pair of fixture children whose fat AABBs
+/// overlap but whose shapes have not touched yet. Pairs are promoted to contacts
+/// when the shapes touch. The pairs of a body are linked through their array
+/// indices.
+struct b2ContactPair
+{
+	enum
+	{
+		e_filterFlag = 0x0001
+	};
+
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	int32 indexA;
+	int32 indexB;
+
+	// Links in the pair list of body A and body B.
+	int32 prevA;
+	int32 nextA;
+	int32 prevB;
+	int32 nextB;
+
+	uint32 flags;
+};
+
+/// This is an internal structure. The contacts of one pair of shape types, packed
+/// at the front of a contiguous array. The contact types add no members to b2Contact,
+/// so the contacts are sizeof(b2Contact) apart.
+struct b2ContactArray
+{
+	b2Contact* GetContact(int32 index) const;
+
+	char* contacts;
+	int32 count;
+	int32 capacity;
+};
+
+/// This is an internal structure. The slot of a destroyed contact, see
+/// b2ContactManager::ReleaseContacts.
+struct b2ContactSlot
+{
+	int32 arrayIndex;
+	int32 index;
+};
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
-	b2ContactManager();
+	// Contact filter modes.
+	enum
+	{
+		e_defaultFilter,
+		e_userFilter,
+		e_functionFilter,
+		e_layerFilter
+	};
+
+	// The number of contact arrays, see b2Contact::GetArrayIndex.
+	enum
+	{
+		e_arrayCount = b2Shape::e_typeCount * b2Shape::e_typeCount
+	};
+
+	b2ContactManager(const b2Allocator* allocator = nullptr);
+	~b2ContactManager();
+
+	// Run the contact filter. The default filter is inlined.
+	bool ShouldCollide(b2Fixture* fixtureA, b2Fixture* fixtureB) const;
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -40,13 +164,117 @@ public:
 	void Destroy(b2Contact* c);
 
 	void Collide();
-            
+
+	// Reserve the pair array, the event buffers and the handles for this many contacts.
+	void Reserve(int32 contactCount);
+
+	// Reserve a contact array. Growing the array moves its contacts.
+	void ReserveContacts(int32 arrayIndex, int32 contactCount);
+
+	// Get the memory for a new contact at the back of a contact array.
+	void* AllocateContact(int32 arrayIndex);
+
+	// Move the last contact of each array into the slots of the destroyed
+	// contacts. This must not be called while contact pointers are held.
+	void ReleaseContacts();
+
+	// Move a contact to new memory and patch the pointers to it.
+	b2Contact* MoveContact(b2Contact* c, void* mem);
+
+	// Add a contact to the world list.
+	void AddContact(b2Contact* c);
+
+	// Create a contact and connect it to the body contact lists.
+	b2Contact* CreateContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
+	// Does this body pair need a contact even before the shapes touch?
+	bool NeedsContact(const b2Body* bodyA, const b2Body* bodyB) const;
+
+	void CreatePair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
+	// Swap remove a pair from the pair array.
+	void DestroyPair(int32 index);
+
+	// Destroy the pairs of a body. Only the pairs of the fixture are destroyed
+	// if the fixture is not null.
+	void DestroyPairs(b2Body* body, const b2Fixture* fixture);
+
+	// Flag pairs for filtering. Filtering will occur the next time step.
+	void FlagPairsForFiltering(const b2Fixture* fixture);
+	void FlagPairsForFiltering(const b2Body* bodyA, const b2Body* bodyB);
+
+	// Replace the pointers to a fixture that was moved by world compaction.
+	void RelocateFixture(b2Fixture* oldFixture, b2Fixture* newFixture);
+
+	// Buffer the events of a contact that started or stopped touching.
+	void ReportBeginTouch(b2Contact* c);
+	void ReportEndTouch(b2Contact* c);
+
+	// Buffer an impulse event, called by b2Island::Report.
+	void ReportImpulse(b2Contact* c, const b2ContactImpulse& impulse);
+
+	// Clear the events of the last time step. The end events recorded after it are kept.
+	void ClearEvents();
+
 	b2BroadPhase m_broadPhase;
+	b2SensorManager m_sensorManager;
 	b2Contact* m_contactList;
+
+	// The contacts by shape types, so hot loops stream through the contacts of one
+	// type. A destroyed contact leaves a hole in its array until ReleaseContacts
+	// moves the last contact of the array into it. The world list, the body lists
+	// and the handles are patched when a contact moves.
+	b2ContactArray m_contactArrays[e_arrayCount];
 	int32 m_contactCount;
+
+	b2ContactSlot* m_freeSlots;
+	int32 m_freeSlotCount;
+	int32 m_freeSlotCapacity;
+
+	b2ContactPair* m_pairs;
+	int32 m_pairCount;
+	int32 m_pairCapacity;
+
+	b2HandleTable m_contactIds;
 	b2ContactFilter* m_contactFilter;
+	b2ContactFilterFcn* m_contactFilterFcn;
+	void* m_contactFilterContext;
+	uint32 m_layerMatrix[b2_maxCollisionLayers];
+	int32 m_filterMode;
 	b2ContactListener* m_contactListener;
-	b2BlockAllocator* m_allocator;
+	b2RelocationListener* m_relocationListener;
+
+	// The memory callbacks of the arrays and event buffers.
+	b2Allocator m_arrayAllocator;
+
+	b2ContactBeginTouchEvent* m_beginEvents;
+	int32 m_beginEventCount;
+	int32 m_beginEventCapacity;
+
+	b2ContactEndTouchEvent* m_endEvents;
+	int32 m_endEventCount;
+	int32 m_endEventCapacity;
+
+	// The end event count at the end of the last time step. Later end events come
+	// from contacts destroyed between time steps and are carried over by ClearEvents.
+	int32 m_stepEndEventCount;
+
+	b2ContactHitEvent* m_hitEvents;
+	int32 m_hitEventCount;
+	int32 m_hitEventCapacity;
+
+	b2ContactImpulseEvent* m_impulseEvents;
+	int32 m_impulseEventCount;
+	int32 m_impulseEventCapacity;
+
+	float32 m_hitEventThreshold;
+	float32 m_impulseEventThreshold;
 };
 
+inline b2Contact* b2ContactArray::GetContact(int32 index) const
+{
+	b2Assert(0 <= index && index < capacity);
+	return (b2Contact*)(contacts + index * sizeof(b2Contact));
+}
+
 #endif
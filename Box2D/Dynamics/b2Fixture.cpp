@@ -30,15 +30,20 @@
 b2Fixture::b2Fixture()
 {
 	m_userData = nullptr;
+	m_id = b2_nullId;
 	m_body = nullptr;
 	m_next = nullptr;
 	m_proxies = nullptr;
 	m_proxyCount = 0;
 	m_shape = nullptr;
 	m_density = 0.0f;
+	m_sensor = nullptr;
+	m_visitCount = 0;
+	m_shared = false;
+	m_sharedShape = nullptr;
 }
 
-void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def)
+void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def, bool shared)
 {
 	m_userData = def->userData;
 	m_friction = def->friction;
@@ -48,10 +53,29 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 	m_next = nullptr;
 
 	m_filter = def->filter;
+	b2Assert(m_filter.layer < b2_maxCollisionLayers);
 
 	m_isSensor = def->isSensor;
-
-	m_shape = def->shape->Clone(allocator);
+	m_enableContactEvents = def->enableContactEvents;
+	m_enableHitEvents = def->enableHitEvents;
+	m_enableImpulseEvents = def->enableImpulseEvents;
+	m_oneSided = def->oneSided;
+	m_oneSidedNormal = def->oneSidedNormal;
+	b2Assert(m_oneSided == false || b2Abs(m_oneSidedNormal.Length() - 1.0f) < b2_linearSlop);
+	m_sensor = nullptr;
+	m_visitCount = 0;
+
+	m_shared = shared;
+	m_sharedShape = def->sharedShape;
+	if (m_sharedShape)
+	{
+		m_sharedShape->Retain();
+		m_shape = (b2Shape*)m_sharedShape->GetShape();
+	}
+	else
+	{
+		m_shape = shared ? (b2Shape*)def->shape : def->shape->Clone(allocator);
+	}
 
 	// Reserve proxy space
 	int32 childCount = m_shape->GetChildCount();
@@ -76,6 +100,21 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy));
 	m_proxies = nullptr;
 
+	// A shared shape belongs to the b2SharedShape or to the geometry.
+	if (m_sharedShape)
+	{
+		m_sharedShape->Release();
+		m_sharedShape = nullptr;
+		m_shape = nullptr;
+		return;
+	}
+
+	if (m_shared)
+	{
+		m_shape = nullptr;
+		return;
+	}
+
 	// Free the child shape.
 	switch (m_shape->m_type)
 	{
@@ -122,6 +161,11 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 {
 	b2Assert(m_proxyCount == 0);
+	b2Assert(m_shared == false);
+	if (m_shared)
+	{
+		return;
+	}
 
 	// Create proxies in the broad-phase.
 	m_proxyCount = m_shape->GetChildCount();
@@ -138,6 +182,13 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 
 void b2Fixture::DestroyProxies(b2BroadPhase* broadPhase)
 {
+	// Shared proxies stay in the static tree.
+	b2Assert(m_shared == false);
+	if (m_shared)
+	{
+		return;
+	}
+
 	// Destroy proxies in the broad-phase.
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
@@ -149,6 +200,15 @@ void b2Fixture::DestroyProxies(b2BroadPhase* broadPhase)
 	m_proxyCount = 0;
 }
 
+void b2Fixture::ClearTriggerEvents(b2BroadPhase* broadPhase)
+{
+	int32 childCount = m_shape->GetChildCount();
+	for (int32 i = 0; i < childCount; ++i)
+	{
+		broadPhase->ReplaceTriggerUserData(m_proxies + i, nullptr);
+	}
+}
+
 void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transform1, const b2Transform& transform2)
 {
 	if (m_proxyCount == 0)
@@ -156,6 +216,13 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 		return;
 	}
 
+	// Shared fixtures cannot move.
+	b2Assert(m_shared == false);
+	if (m_shared)
+	{
+		return;
+	}
+
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
@@ -175,11 +242,76 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 
 void b2Fixture::SetFilterData(const b2Filter& filter)
 {
+	b2Assert(filter.layer < b2_maxCollisionLayers);
 	m_filter = filter;
 
 	Refilter();
 }
 
+void b2Fixture::SetImpulseEventsEnabled(bool flag)
+{
+	m_enableImpulseEvents = flag;
+
+	if (m_body == nullptr)
+	{
+		return;
+	}
+
+	// Update the cached flag of the associated contacts.
+	for (b2ContactEdge* edge = m_body->GetContactList(); edge; edge = edge->next)
+	{
+		b2Contact* contact = edge->contact;
+		b2Fixture* fixtureA = contact->m_fixtureA;
+		b2Fixture* fixtureB = contact->m_fixtureB;
+		if (fixtureA != this && fixtureB != this)
+		{
+			continue;
+		}
+
+		if (fixtureA->m_enableImpulseEvents || fixtureB->m_enableImpulseEvents)
+		{
+			contact->m_flags |= b2Contact::e_impulseEventsFlag;
+		}
+		else
+		{
+			contact->m_flags &= ~b2Contact::e_impulseEventsFlag;
+		}
+	}
+}
+
+void b2Fixture::SetOneSided(bool flag, const b2Vec2& normal)
+{
+	b2Assert(flag == false || b2Abs(normal.Length() - 1.0f) < b2_linearSlop);
+	m_oneSided = flag;
+	m_oneSidedNormal = normal;
+
+	if (m_body == nullptr)
+	{
+		return;
+	}
+
+	// Update the cached flag of the associated contacts.
+	for (b2ContactEdge* edge = m_body->GetContactList(); edge; edge = edge->next)
+	{
+		b2Contact* contact = edge->contact;
+		b2Fixture* fixtureA = contact->m_fixtureA;
+		b2Fixture* fixtureB = contact->m_fixtureB;
+		if (fixtureA != this && fixtureB != this)
+		{
+			continue;
+		}
+
+		if (fixtureA->m_oneSided || fixtureB->m_oneSided)
+		{
+			contact->m_flags |= b2Contact::e_oneSidedFlag;
+		}
+		else
+		{
+			contact->m_flags &= ~(b2Contact::e_oneSidedFlag | b2Contact::e_oneSidedRejectFlag);
+		}
+	}
+}
+
 void b2Fixture::Refilter()
 {
 	if (m_body == nullptr)
@@ -209,6 +341,11 @@ void b2Fixture::Refilter()
 		return;
 	}
 
+	world->m_contactManager.FlagPairsForFiltering(this);
+
+	// Sensor overlaps are re-filtered when the pairs are reported again.
+	world->m_contactManager.m_sensorManager.RemoveFixture(this);
+
 	// Touch each proxy so that new pairs may be created
 	b2BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
 	for (int32 i = 0; i < m_proxyCount; ++i)
@@ -219,11 +356,101 @@ void b2Fixture::Refilter()
 
 void b2Fixture::SetSensor(bool sensor)
 {
-	if (sensor != m_isSensor)
+	if (sensor == m_isSensor)
+	{
+		return;
+	}
+
+	b2World* world = m_body->GetWorld();
+	b2Assert(world->IsLocked() == false);
+	if (world->IsLocked() == true)
+	{
+		return;
+	}
+
+	b2ContactManager* contactManager = &world->m_contactManager;
+	b2SensorManager* sensorManager = &contactManager->m_sensorManager;
+
+	if (sensor)
+	{
+		// Sensors don't have contacts.
+		b2ContactEdge* edge = m_body->GetContactList();
+		while (edge)
+		{
+			b2Contact* c = edge->contact;
+			edge = edge->next;
+
+			if (c->GetFixtureA() == this || c->GetFixtureB() == this)
+			{
+				contactManager->Destroy(c);
+			}
+		}
+		contactManager->DestroyPairs(m_body, this);
+
+		// Sensors don't visit other sensors.
+		sensorManager->RemoveFixture(this);
+
+		m_isSensor = true;
+		m_sensor = sensorManager->CreateSensor(this);
+	}
+	else
+	{
+		sensorManager->RemoveFixture(this);
+		sensorManager->DestroySensor(m_sensor);
+		m_sensor = nullptr;
+		m_isSensor = false;
+	}
+
+	m_body->SetAwake(true);
+
+	// Touch each proxy so that new pairs are created.
+	b2BroadPhase* broadPhase = &contactManager->m_broadPhase;
+	for (int32 i = 0; i < m_proxyCount; ++i)
+	{
+		broadPhase->TouchProxy(m_proxies[i].proxyId);
+	}
+}
+
+const b2SensorOverlap* b2Fixture::GetSensorOverlaps() const
+{
+	return m_sensor ? m_sensor->overlaps : nullptr;
+}
+
+int32 b2Fixture::GetSensorOverlapCount() const
+{
+	return m_sensor ? m_sensor->touchingCount : 0;
+}
+
+const b2SensorEvent* b2Fixture::GetSensorBeginEvents() const
+{
+	if (m_sensor == nullptr || m_sensor->beginCount == 0)
 	{
-		m_body->SetAwake(true);
-		m_isSensor = sensor;
+		return nullptr;
 	}
+
+	const b2SensorManager* sensorManager = &m_body->GetWorld()->m_contactManager.m_sensorManager;
+	return sensorManager->m_beginEvents + m_sensor->beginIndex;
+}
+
+int32 b2Fixture::GetSensorBeginEventCount() const
+{
+	return m_sensor ? m_sensor->beginCount : 0;
+}
+
+const b2SensorEvent* b2Fixture::GetSensorEndEvents() const
+{
+	if (m_sensor == nullptr || m_sensor->endCount == 0)
+	{
+		return nullptr;
+	}
+
+	const b2SensorManager* sensorManager = &m_body->GetWorld()->m_contactManager.m_sensorManager;
+	return sensorManager->m_endEvents + m_sensor->endIndex;
+}
+
+int32 b2Fixture::GetSensorEndEventCount() const
+{
+	return m_sensor ? m_sensor->endCount : 0;
 }
 
 void b2Fixture::Dump(int32 bodyIndex)
@@ -233,9 +460,15 @@ void b2Fixture::Dump(int32 bodyIndex)
 	b2Log("    fd.restitution = %.15lef;\n", m_restitution);
 	b2Log("    fd.density = %.15lef;\n", m_density);
 	b2Log("    fd.isSensor = bool(%d);\n", m_isSensor);
+	b2Log("    fd.enableContactEvents = bool(%d);\n", m_enableContactEvents);
+	b2Log("    fd.enableHitEvents = bool(%d);\n", m_enableHitEvents);
+	b2Log("    fd.enableImpulseEvents = bool(%d);\n", m_enableImpulseEvents);
+	b2Log("    fd.oneSided = bool(%d);\n", m_oneSided);
+	b2Log("    fd.oneSidedNormal.Set(%.15lef, %.15lef);\n", m_oneSidedNormal.x, m_oneSidedNormal.y);
 	b2Log("    fd.filter.categoryBits = uint16(%d);\n", m_filter.categoryBits);
 	b2Log("    fd.filter.maskBits = uint16(%d);\n", m_filter.maskBits);
 	b2Log("    fd.filter.groupIndex = int16(%d);\n", m_filter.groupIndex);
+	b2Log("    fd.filter.layer = uint8(%d);\n", m_filter.layer);
 
 	switch (m_shape->m_type)
 	{
@@ -22,11 +22,15 @@
 #include "Box2D/Dynamics/b2Body.h"
 #include "Box2D/Collision/b2Collision.h"
 #include "Box2D/Collision/Shapes/b2Shape.h"
+#include "Box2D/Collision/Shapes/b2SharedShape.h"
 
 class b2BlockAllocator;
 class b2Body;
 class b2BroadPhase;
 class b2Fixture;
+struct b2Sensor;
+struct b2SensorEvent;
+struct b2SensorOverlap;
 
 /// This holds contact filtering data.
 struct b2Filter
@@ -36,6 +40,7 @@ struct b2Filter
 		categoryBits = 0x0001;
 		maskBits = 0xFFFF;
 		groupIndex = 0;
+		layer = 0;
 	}
 
 	/// The collision category bits. Normally you would just set one bit.
@@ -49,8 +54,24 @@ struct b2Filter
 	/// or always collide (positive). Zero means no collision group. Non-zero group
 	/// filtering always wins against the mask bits.
 	int16 groupIndex;
+
+	/// The collision layer, used instead of the bits above when the world has a
+	/// layer collision matrix. Must be less than b2_maxCollisionLayers.
+	uint8 layer;
 };
 
+/// Test the group and mask bits of two filters. This is the test done by the default
+/// contact filter.
+inline bool b2TestFilter(const b2Filter& filterA, const b2Filter& filterB)
+{
+	if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+	{
+		return filterA.groupIndex > 0;
+	}
+
+	return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+}
+
 /// A fixture definition is used to create a fixture. This class defines an
 /// abstract fixture definition. You can reuse fixture definitions safely.
 struct b2FixtureDef
@@ -59,17 +80,27 @@ struct b2FixtureDef
 	b2FixtureDef()
 	{
 		shape = nullptr;
+		sharedShape = nullptr;
 		userData = nullptr;
 		friction = 0.2f;
 		restitution = 0.0f;
 		density = 0.0f;
 		isSensor = false;
+		enableContactEvents = false;
+		enableHitEvents = false;
+		enableImpulseEvents = false;
+		oneSided = false;
+		oneSidedNormal.Set(0.0f, 1.0f);
 	}
 
-	/// The shape, this must be set. The shape will be cloned, so you
-	/// can create the shape on the stack.
+	/// The shape, this must be set unless a shared shape is used. The shape will be
+	/// cloned, so you can create the shape on the stack.
 	const b2Shape* shape;
 
+	/// A shared shape to reference instead of cloning the shape. The fixture holds
+	/// a reference to it. When this is set the shape is ignored.
+	b2SharedShape* sharedShape;
+
 	/// Use this to store application specific fixture data.
 	void* userData;
 
@@ -82,10 +113,32 @@ struct b2FixtureDef
 	/// The density, usually in kg/m^2.
 	float32 density;
 
-	/// A sensor shape collects contact information but never generates a collision
-	/// response.
+	/// A sensor shape collects overlap information but never generates a collision
+	/// response. Sensors do not create contacts, see b2Fixture::GetSensorOverlaps. So they
+	/// are not reported to b2ContactListener, and two sensors do not detect each other.
 	bool isSensor;
 
+	/// Buffer begin/end touch events for the contacts of this fixture.
+	/// @see b2World::GetContactBeginEvents
+	bool enableContactEvents;
+
+	/// Buffer hit events for the contacts of this fixture.
+	/// @see b2World::GetContactHitEvents
+	bool enableHitEvents;
+
+	/// Buffer impulse events for the contacts of this fixture. Only the contacts
+	/// with impulse events have their solver impulses gathered after the time step.
+	/// @see b2World::GetContactImpulseEvents
+	bool enableImpulseEvents;
+
+	/// A one-sided fixture only collides with shapes that approach from the side
+	/// its normal points to. Useful for platforms that can be jumped through
+	/// from below. This does not require a contact listener.
+	bool oneSided;
+
+	/// The one-sided normal in body coordinates. This must be a unit vector.
+	b2Vec2 oneSidedNormal;
+
 	/// Contact filtering data.
 	b2Filter filter;
 };
@@ -117,13 +170,62 @@ public:
 	b2Shape* GetShape();
 	const b2Shape* GetShape() const;
 
-	/// Set if this fixture is a sensor.
+	/// Set if this fixture is a sensor. This destroys the contacts or sensor
+	/// overlaps of this fixture. They are rebuilt on the next time step.
+	/// @warning This function is locked during callbacks.
 	void SetSensor(bool sensor);
 
 	/// Is this fixture a sensor (non-solid)?
 	/// @return the true if the shape is a sensor.
 	bool IsSensor() const;
 
+	/// Get the visitor fixtures currently overlapping this sensor.
+	/// Sensors do not detect other sensors.
+	/// @return nullptr if this fixture is not a sensor.
+	const b2SensorOverlap* GetSensorOverlaps() const;
+
+	/// Get the number of visitors currently overlapping this sensor.
+	int32 GetSensorOverlapCount() const;
+
+	/// Get the visitors that began overlapping this sensor during the last time step.
+	/// @see b2World::GetSensorBeginEvents
+	const b2SensorEvent* GetSensorBeginEvents() const;
+	int32 GetSensorBeginEventCount() const;
+
+	/// Get the visitors that ended overlapping this sensor during the last time step.
+	/// @see b2World::GetSensorEndEvents
+	const b2SensorEvent* GetSensorEndEvents() const;
+	int32 GetSensorEndEventCount() const;
+
+	/// Enable/disable buffered begin/end touch events for the contacts of this fixture.
+	void SetContactEventsEnabled(bool flag);
+
+	/// Are buffered begin/end touch events enabled?
+	bool IsContactEventsEnabled() const;
+
+	/// Enable/disable buffered hit events for the contacts of this fixture.
+	void SetHitEventsEnabled(bool flag);
+
+	/// Are buffered hit events enabled?
+	bool IsHitEventsEnabled() const;
+
+	/// Enable/disable buffered impulse events for the contacts of this fixture.
+	void SetImpulseEventsEnabled(bool flag);
+
+	/// Are buffered impulse events enabled?
+	bool IsImpulseEventsEnabled() const;
+
+	/// Make this fixture one-sided. The normal is in body coordinates and must be a unit vector.
+	/// Contacts that are already touching keep their state until the shapes separate.
+	/// @see b2FixtureDef::oneSided
+	void SetOneSided(bool flag, const b2Vec2& normal);
+
+	/// Is this fixture one-sided?
+	bool IsOneSided() const;
+
+	/// Get the one-sided normal in body coordinates.
+	const b2Vec2& GetOneSidedNormal() const;
+
 	/// Set the contact filtering data. This will not update contacts until the next time
 	/// step when either parent body is active and awake.
 	/// This automatically calls Refilter.
@@ -145,6 +247,10 @@ public:
 	b2Fixture* GetNext();
 	const b2Fixture* GetNext() const;
 
+	/// Get the handle of this fixture. The handle is invalid after the fixture is destroyed.
+	/// @see b2World::GetFixture
+	b2FixtureId GetId() const;
+
 	/// Get the user data that was assigned in the fixture definition. Use this to
 	/// store your application specific data.
 	void* GetUserData() const;
@@ -201,18 +307,23 @@ protected:
 	friend class b2World;
 	friend class b2Contact;
 	friend class b2ContactManager;
+	friend class b2SensorManager;
 
 	b2Fixture();
 
 	// We need separation create/destroy functions from the constructor/destructor because
 	// the destructor cannot access the allocator (no destructor arguments allowed by C++).
-	void Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def);
+	// A shared fixture uses the shape of the definition, see b2StaticGeometry.
+	void Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def, bool shared = false);
 	void Destroy(b2BlockAllocator* allocator);
 
 	// These support body activation/deactivation.
 	void CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf);
 	void DestroyProxies(b2BroadPhase* broadPhase);
 
+	// Clear the proxies of a destroyed fixture from the buffered trigger events.
+	void ClearTriggerEvents(b2BroadPhase* broadPhase);
+
 	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
 
 	float32 m_density;
@@ -230,7 +341,26 @@ protected:
 
 	b2Filter m_filter;
 
+	// The shape and the proxies belong to a b2StaticGeometry.
+	bool m_shared;
+
+	// The shape belongs to this shared shape, see b2FixtureDef::sharedShape.
+	b2SharedShape* m_sharedShape;
+
 	bool m_isSensor;
+	bool m_enableContactEvents;
+	bool m_enableHitEvents;
+	bool m_enableImpulseEvents;
+	bool m_oneSided;
+	b2Vec2 m_oneSidedNormal;
+
+	// Overlap state when this fixture is a sensor.
+	b2Sensor* m_sensor;
+
+	// Number of sensor overlaps that reference this fixture as a visitor.
+	int32 m_visitCount;
+
+	b2FixtureId m_id;
 
 	void* m_userData;
 };
@@ -255,11 +385,51 @@ inline bool b2Fixture::IsSensor() const
 	return m_isSensor;
 }
 
+inline void b2Fixture::SetContactEventsEnabled(bool flag)
+{
+	m_enableContactEvents = flag;
+}
+
+inline bool b2Fixture::IsContactEventsEnabled() const
+{
+	return m_enableContactEvents;
+}
+
+inline void b2Fixture::SetHitEventsEnabled(bool flag)
+{
+	m_enableHitEvents = flag;
+}
+
+inline bool b2Fixture::IsHitEventsEnabled() const
+{
+	return m_enableHitEvents;
+}
+
+inline bool b2Fixture::IsImpulseEventsEnabled() const
+{
+	return m_enableImpulseEvents;
+}
+
+inline bool b2Fixture::IsOneSided() const
+{
+	return m_oneSided;
+}
+
+inline const b2Vec2& b2Fixture::GetOneSidedNormal() const
+{
+	return m_oneSidedNormal;
+}
+
 inline const b2Filter& b2Fixture::GetFilterData() const
 {
 	return m_filter;
 }
 
+inline b2FixtureId b2Fixture::GetId() const
+{
+	return m_id;
+}
+
 inline void* b2Fixture::GetUserData() const
 {
 	return m_userData;
@@ -333,6 +503,14 @@ inline bool b2Fixture::RayCast(b2RayCastOutput* output, const b2RayCastInput& in
 
 inline void b2Fixture::GetMassData(b2MassData* massData) const
 {
+	if (m_sharedShape)
+	{
+		*massData = m_sharedShape->GetMassData();
+		massData->mass *= m_density;
+		massData->I *= m_density;
+		return;
+	}
+
 	m_shape->ComputeMass(massData, m_density);
 }
 
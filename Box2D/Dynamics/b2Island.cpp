@@ -27,6 +27,8 @@
 #include "Box2D/Common/b2StackAllocator.h"
 #include "Box2D/Common/b2Timer.h"
 
+extern b2ContactListener b2_defaultListener;
+
 /*
 Position Correction Notes
 =========================
@@ -150,7 +152,7 @@ b2Island::b2Island(
 	int32 contactCapacity,
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
-	b2ContactListener* listener)
+	b2ContactManager* contactManager)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -158,13 +160,22 @@ b2Island::b2Island(
 	m_bodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
+	m_brokenJointCount = 0;
 
 	m_allocator = allocator;
-	m_listener = listener;
+	m_contactManager = contactManager;
+
+	// The default listener ignores PostSolve, so the impulses are not gathered for it.
+	m_listener = contactManager->m_contactListener;
+	if (m_listener == &b2_defaultListener)
+	{
+		m_listener = nullptr;
+	}
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
 	m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
+	m_brokenJoints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
@@ -175,6 +186,7 @@ b2Island::~b2Island()
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
+	m_allocator->Free(m_brokenJoints);
 	m_allocator->Free(m_joints);
 	m_allocator->Free(m_contacts);
 	m_allocator->Free(m_bodies);
@@ -190,21 +202,22 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
+		b2Sweep& sweep = b->Sweep();
 
-		b2Vec2 c = b->m_sweep.c;
-		float32 a = b->m_sweep.a;
-		b2Vec2 v = b->m_linearVelocity;
-		float32 w = b->m_angularVelocity;
+		b2Vec2 c = sweep.c;
+		float32 a = sweep.a;
+		b2Vec2 v = b->LinearVelocity();
+		float32 w = b->AngularVelocity();
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		sweep.c0 = sweep.c;
+		sweep.a0 = sweep.a;
 
 		if (b->m_type == b2_dynamicBody)
 		{
 			// Integrate velocities.
-			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
-			w += h * b->m_invI * b->m_torque;
+			v += h * (b->m_gravityScale * gravity + b->InvMass() * b->Force());
+			w += h * b->InvI() * b->Torque();
 
 			// Apply damping.
 			// ODE: dv/dt + c * v = 0
@@ -269,6 +282,29 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	// Store impulses for warm starting
 	contactSolver.StoreImpulses();
+
+	// Check the joint break thresholds. Broken joints are removed from the island
+	// so they don't take part in the position solver.
+	int32 jointCount = 0;
+	for (int32 i = 0; i < m_jointCount; ++i)
+	{
+		b2Joint* joint = m_joints[i];
+		if (joint->m_breakable)
+		{
+			b2Vec2 force = joint->GetReactionForce(step.inv_dt);
+			float32 torque = joint->GetReactionTorque(step.inv_dt);
+			if (force.LengthSquared() > joint->m_breakForce * joint->m_breakForce ||
+				b2Abs(torque) > joint->m_breakTorque)
+			{
+				m_brokenJoints[m_brokenJointCount++] = joint;
+				continue;
+			}
+		}
+
+		m_joints[jointCount++] = joint;
+	}
+	m_jointCount = jointCount;
+
 	profile->solveVelocity = timer.GetMilliseconds();
 
 	// Integrate positions
@@ -330,10 +366,11 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		b2Sweep& sweep = body->Sweep();
+		sweep.c = m_positions[i].c;
+		sweep.a = m_positions[i].a;
+		body->LinearVelocity() = m_velocities[i].v;
+		body->AngularVelocity() = m_velocities[i].w;
 		body->SynchronizeTransform();
 	}
 
@@ -357,8 +394,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			}
 
 			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+				b->AngularVelocity() * b->AngularVelocity() > angTolSqr ||
+				b2Dot(b->LinearVelocity(), b->LinearVelocity()) > linTolSqr)
 			{
 				b->m_sleepTime = 0.0f;
 				minSleepTime = 0.0f;
@@ -389,11 +426,12 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	// Initialize the body state.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Body* b = m_bodies[i];
-		m_positions[i].c = b->m_sweep.c;
-		m_positions[i].a = b->m_sweep.a;
-		m_velocities[i].v = b->m_linearVelocity;
-		m_velocities[i].w = b->m_angularVelocity;
+		const b2Body* b = m_bodies[i];
+		const b2Sweep& sweep = b->Sweep();
+		m_positions[i].c = sweep.c;
+		m_positions[i].a = sweep.a;
+		m_velocities[i].v = b->LinearVelocity();
+		m_velocities[i].w = b->AngularVelocity();
 	}
 
 	b2ContactSolverDef contactSolverDef;
@@ -449,10 +487,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 #endif
 
 	// Leap of faith to new safe state.
-	m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
-	m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
-	m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
-	m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+	m_bodies[toiIndexA]->Sweep().c0 = m_positions[toiIndexA].c;
+	m_bodies[toiIndexA]->Sweep().a0 = m_positions[toiIndexA].a;
+	m_bodies[toiIndexB]->Sweep().c0 = m_positions[toiIndexB].c;
+	m_bodies[toiIndexB]->Sweep().a0 = m_positions[toiIndexB].a;
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
@@ -503,10 +541,11 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 		// Sync bodies
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = c;
-		body->m_sweep.a = a;
-		body->m_linearVelocity = v;
-		body->m_angularVelocity = w;
+		b2Sweep& sweep = body->Sweep();
+		sweep.c = c;
+		sweep.a = a;
+		body->LinearVelocity() = v;
+		body->AngularVelocity() = w;
 		body->SynchronizeTransform();
 	}
 
@@ -515,25 +554,39 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == nullptr)
-	{
-		return;
-	}
+	float32 threshold = m_contactManager->m_impulseEventThreshold;
 
 	for (int32 i = 0; i < m_contactCount; ++i)
 	{
 		b2Contact* c = m_contacts[i];
 
+		// Only gather the impulses of contacts that are reported.
+		bool impulseEvents = (c->m_flags & b2Contact::e_impulseEventsFlag) == b2Contact::e_impulseEventsFlag;
+		if (m_listener == nullptr && impulseEvents == false)
+		{
+			continue;
+		}
+
 		const b2ContactVelocityConstraint* vc = constraints + i;
 		
 		b2ContactImpulse impulse;
 		impulse.count = vc->pointCount;
+		float32 maxImpulse = 0.0f;
 		for (int32 j = 0; j < vc->pointCount; ++j)
 		{
 			impulse.normalImpulses[j] = vc->points[j].normalImpulse;
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+			maxImpulse = b2Max(maxImpulse, vc->points[j].normalImpulse);
+		}
+
+		if (m_listener)
+		{
+			m_listener->PostSolve(c, &impulse);
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (impulseEvents && maxImpulse >= threshold)
+		{
+			m_contactManager->ReportImpulse(c, impulse);
+		}
 	}
 }
@@ -27,6 +27,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+class b2ContactManager;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -35,7 +36,7 @@ class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactManager* contactManager);
 	~b2Island();
 
 	void Clear()
@@ -43,6 +44,7 @@ public:
 		m_bodyCount = 0;
 		m_contactCount = 0;
 		m_jointCount = 0;
+		m_brokenJointCount = 0;
 	}
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
@@ -72,11 +74,13 @@ public:
 	void Report(const b2ContactVelocityConstraint* constraints);
 
 	b2StackAllocator* m_allocator;
+	b2ContactManager* m_contactManager;
 	b2ContactListener* m_listener;
 
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
+	b2Joint** m_brokenJoints;
 
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -84,6 +88,7 @@ public:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
+	int32 m_brokenJointCount;
 
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
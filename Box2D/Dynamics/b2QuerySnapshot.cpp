@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Dynamics/b2QuerySnapshot.h"
+#include "Box2D/Dynamics/b2StaticGeometry.h"
+#include "Box2D/Collision/Shapes/b2ChainShape.h"
+#include "Box2D/Collision/b2BroadPhase.h"
+#include <new>
+
+b2QuerySnapshot* b2QuerySnapshot::Create(const b2Allocator& allocator)
+{
+	void* mem = allocator.Allocate(sizeof(b2QuerySnapshot));
+	return new (mem) b2QuerySnapshot(allocator);
+}
+
+b2QuerySnapshot::b2QuerySnapshot(const b2Allocator& allocator)
+	: m_tree(&allocator)
+	, m_allocator(allocator)
+{
+	m_proxies = nullptr;
+	m_shapes = nullptr;
+	m_proxyCapacity = 0;
+
+	m_staticGeometry = nullptr;
+	m_staticBodyId = b2_nullId;
+	m_staticProxies = nullptr;
+	m_staticProxyCapacity = 0;
+
+	m_version = 0;
+}
+
+b2QuerySnapshot::~b2QuerySnapshot()
+{
+	if (m_staticGeometry)
+	{
+		m_staticGeometry->Release();
+	}
+
+	m_allocator.Free(m_proxies);
+	m_allocator.Free(m_shapes);
+	m_allocator.Free(m_staticProxies);
+}
+
+void b2QuerySnapshot::Retain()
+{
+	m_refCount.Retain();
+}
+
+void b2QuerySnapshot::Release()
+{
+	if (m_refCount.Release())
+	{
+		b2Allocator allocator = m_allocator;
+		this->~b2QuerySnapshot();
+		allocator.Free(this);
+	}
+}
+
+const b2QueryProxy* b2QuerySnapshot::GetProxy(int32 proxyId) const
+{
+	if (b2BroadPhase::IsStaticProxy(proxyId))
+	{
+		int32 index = proxyId - b2BroadPhase::e_staticProxy;
+		b2Assert(index < m_staticProxyCapacity);
+		return m_staticProxies + index;
+	}
+
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	return m_proxies + proxyId;
+}
+
+const b2Shape* b2QuerySnapshot::CopyShape(int32 proxyId, const b2Shape* shape, int32 childIndex)
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	b2SnapshotShape* copy = m_shapes + proxyId;
+
+	switch (shape->m_type)
+	{
+	case b2Shape::e_circle:
+		return new (&copy->circle) b2CircleShape(*(const b2CircleShape*)shape);
+
+	case b2Shape::e_edge:
+		return new (&copy->edge) b2EdgeShape(*(const b2EdgeShape*)shape);
+
+	case b2Shape::e_polygon:
+		return new (&copy->polygon) b2PolygonShape(*(const b2PolygonShape*)shape);
+
+	case b2Shape::e_chain:
+		{
+			// The edge ignores the child index of the proxy.
+			b2EdgeShape* edge = new (&copy->edge) b2EdgeShape;
+			((const b2ChainShape*)shape)->GetChildEdge(edge, childIndex);
+			return edge;
+		}
+
+	default:
+		b2Assert(false);
+		return nullptr;
+	}
+}
+
+struct b2SnapshotQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		const b2QueryProxy* proxy = snapshot->GetProxy(proxyId);
+		if (proxy->fixtureId == b2_nullId)
+		{
+			// A trigger.
+			return true;
+		}
+
+		return callback->ReportProxy(proxy);
+	}
+
+	const b2QuerySnapshot* snapshot;
+	b2SnapshotQueryCallback* callback;
+};
+
+void b2QuerySnapshot::QueryAABB(b2SnapshotQueryCallback* callback, const b2AABB& aabb) const
+{
+	b2SnapshotQueryWrapper query;
+	query.snapshot = this;
+	query.callback = callback;
+
+	b2BroadPhaseWrapper<b2SnapshotQueryWrapper> wrapper;
+	wrapper.callback = &query;
+	wrapper.offset = 0;
+	wrapper.terminated = false;
+	m_tree.Query(&wrapper, aabb);
+
+	if (m_staticGeometry && wrapper.terminated == false)
+	{
+		wrapper.offset = b2BroadPhase::e_staticProxy;
+		m_staticGeometry->GetTree().Query(&wrapper, aabb);
+	}
+}
+
+struct b2SnapshotRayCastWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
+	{
+		const b2QueryProxy* proxy = snapshot->GetProxy(proxyId);
+		if (proxy->fixtureId == b2_nullId)
+		{
+			return input.maxFraction;
+		}
+
+		b2RayCastOutput output;
+		bool hit = proxy->shape->RayCast(&output, input, proxy->transform, proxy->childIndex);
+
+		if (hit)
+		{
+			float32 fraction = output.fraction;
+			b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+			return callback->ReportProxy(proxy, point, output.normal, fraction);
+		}
+
+		return input.maxFraction;
+	}
+
+	const b2QuerySnapshot* snapshot;
+	b2SnapshotRayCastCallback* callback;
+};
+
+void b2QuerySnapshot::RayCast(b2SnapshotRayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const
+{
+	b2SnapshotRayCastWrapper rayCast;
+	rayCast.snapshot = this;
+	rayCast.callback = callback;
+
+	b2RayCastInput input;
+	input.maxFraction = 1.0f;
+	input.p1 = point1;
+	input.p2 = point2;
+
+	b2BroadPhaseWrapper<b2SnapshotRayCastWrapper> wrapper;
+	wrapper.callback = &rayCast;
+	wrapper.offset = 0;
+	wrapper.maxFraction = input.maxFraction;
+	wrapper.terminated = false;
+	m_tree.RayCast(&wrapper, input);
+
+	if (m_staticGeometry && wrapper.terminated == false)
+	{
+		// The static tree continues with the ray clipped by the first tree.
+		input.maxFraction = wrapper.maxFraction;
+		wrapper.offset = b2BroadPhase::e_staticProxy;
+		m_staticGeometry->GetTree().RayCast(&wrapper, input);
+	}
+}
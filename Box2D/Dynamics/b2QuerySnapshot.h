@@ -0,0 +1,165 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_QUERY_SNAPSHOT_H
+#define B2_QUERY_SNAPSHOT_H
+
+#include "Box2D/Collision/b2DynamicTree.h"
+#include "Box2D/Collision/Shapes/b2CircleShape.h"
+#include "Box2D/Collision/Shapes/b2EdgeShape.h"
+#include "Box2D/Collision/Shapes/b2PolygonShape.h"
+#include "Box2D/Common/b2HandleTable.h"
+#include "Box2D/Common/b2RefCount.h"
+#include "Box2D/Dynamics/b2Fixture.h"
+
+class b2StaticGeometry;
+
+/// A fixture child in a query snapshot. The values are copies taken at the end of the
+/// time step. The shape is a copy of the child primitive owned by the snapshot, so the
+/// fixture may be destroyed while the snapshot is queried. The child of a chain is copied
+/// as an edge. Fixtures of the static geometry use the shapes of the geometry.
+struct b2QueryProxy
+{
+	b2FixtureId fixtureId;		///< the fixture handle, b2_nullId for unused entries
+	b2BodyId bodyId;			///< the body handle
+	int32 childIndex;			///< the child primitive index of the shape
+	const b2Shape* shape;		///< the child primitive of the fixture shape
+	b2Transform transform;		///< the body transform
+	b2Filter filter;			///< the fixture filter
+	void* userData;				///< the fixture user data
+	bool isSensor;				///< true for sensor fixtures
+};
+
+/// Storage for the copy of a child primitive in a snapshot.
+union b2SnapshotShape
+{
+	b2SnapshotShape() {}
+	~b2SnapshotShape() {}
+
+	b2CircleShape circle;
+	b2EdgeShape edge;
+	b2PolygonShape polygon;
+};
+
+/// Callback class for AABB queries of a snapshot.
+/// See b2QuerySnapshot::QueryAABB
+class b2SnapshotQueryCallback
+{
+public:
+	virtual ~b2SnapshotQueryCallback() {}
+
+	/// Called for each fixture child whose fat AABB overlaps the query AABB.
+	/// @return false to terminate the query.
+	virtual bool ReportProxy(const b2QueryProxy* proxy) = 0;
+};
+
+/// Callback class for ray casts of a snapshot. The return value works like
+/// b2RayCastCallback::ReportFixture.
+/// See b2QuerySnapshot::RayCast
+class b2SnapshotRayCastCallback
+{
+public:
+	virtual ~b2SnapshotRayCastCallback() {}
+
+	/// Called for each fixture child hit by the ray.
+	/// @return -1 to filter, 0 to terminate, fraction to clip the ray for
+	/// closest hit, 1 to continue
+	virtual float32 ReportProxy(const b2QueryProxy* proxy, const b2Vec2& point,
+								const b2Vec2& normal, float32 fraction) = 0;
+};
+
+/// A read-only copy of the broad-phase tree and the fixture transforms of a world at the
+/// end of a time step, see b2World::SetQuerySnapshots. Any number of threads may query a
+/// snapshot without locks while the world takes the next time step. The snapshot is
+/// reference counted and stays valid when the world destroys the fixtures it contains.
+/// The entries of the static geometry body are written when the geometry is attached and
+/// are frozen after that: later changes to the filter or user data of its fixtures are not
+/// seen by snapshots.
+class b2QuerySnapshot
+{
+public:
+	/// Add a reference, see b2RefCount.
+	void Retain();
+
+	/// Remove a reference. The world reuses a snapshot once it holds the only reference.
+	void Release();
+
+	/// Get the current reference count.
+	int32 GetReferenceCount() const;
+
+	/// Get the number of snapshots the world published before this one.
+	uint32 GetVersion() const;
+
+	/// Query the snapshot for all fixture children that potentially overlap the
+	/// provided AABB. Triggers are not reported.
+	void QueryAABB(b2SnapshotQueryCallback* callback, const b2AABB& aabb) const;
+
+	/// Ray-cast the snapshot for all fixture children in the path of the ray.
+	/// The ray-cast ignores shapes that contain the starting point.
+	void RayCast(b2SnapshotRayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
+
+private:
+
+	friend class b2World;
+	friend struct b2SnapshotQueryWrapper;
+	friend struct b2SnapshotRayCastWrapper;
+
+	// The memory comes from the allocator of the world, so its callbacks must stay
+	// valid until the last reference is released.
+	static b2QuerySnapshot* Create(const b2Allocator& allocator);
+
+	b2QuerySnapshot(const b2Allocator& allocator);
+	~b2QuerySnapshot();
+
+	const b2QueryProxy* GetProxy(int32 proxyId) const;
+
+	// Copy the child primitive of a shape into the storage of a tree proxy.
+	const b2Shape* CopyShape(int32 proxyId, const b2Shape* shape, int32 childIndex);
+
+	// Copy of the broad-phase tree of the moving proxies.
+	b2DynamicTree m_tree;
+
+	// Indexed by the tree proxy id.
+	b2QueryProxy* m_proxies;
+	b2SnapshotShape* m_shapes;
+	int32 m_proxyCapacity;
+
+	// The static geometry of the world is immutable, so it is referenced instead
+	// of copied. Its proxies are indexed by the static tree proxy id.
+	b2StaticGeometry* m_staticGeometry;
+	b2BodyId m_staticBodyId;
+	b2QueryProxy* m_staticProxies;
+	int32 m_staticProxyCapacity;
+
+	uint32 m_version;
+
+	b2Allocator m_allocator;
+	b2RefCount m_refCount;
+};
+
+inline int32 b2QuerySnapshot::GetReferenceCount() const
+{
+	return m_refCount.GetCount();
+}
+
+inline uint32 b2QuerySnapshot::GetVersion() const
+{
+	return m_version;
+}
+
+#endif
@@ -0,0 +1,370 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Dynamics/b2SensorManager.h"
+#include "Box2D/Dynamics/b2Body.h"
+#include "Box2D/Dynamics/b2Fixture.h"
+#include "Box2D/Dynamics/b2ContactManager.h"
+#include "Box2D/Collision/b2BroadPhase.h"
+#include "Box2D/Common/b2BlockAllocator.h"
+#include <new>
+#include <string.h>
+
+// Append an event, growing the buffer as needed.
+static void b2PushSensorEvent(b2SensorEvent** events, int32* count, int32* capacity,
+							  const b2Allocator& allocator, const b2Sensor* sensor, const b2SensorOverlap* overlap)
+{
+	if (*count == *capacity)
+	{
+		b2SensorEvent* oldEvents = *events;
+		*capacity = *capacity > 0 ? 2 * *capacity : 16;
+		*events = (b2SensorEvent*)allocator.Allocate(*capacity * sizeof(b2SensorEvent));
+		if (oldEvents)
+		{
+			memcpy(*events, oldEvents, *count * sizeof(b2SensorEvent));
+			allocator.Free(oldEvents);
+		}
+	}
+
+	b2SensorEvent* event = *events + *count;
+	event->sensor = sensor->fixture;
+	event->visitor = overlap->fixture;
+	event->sensorId = sensor->fixture->GetId();
+	event->visitorId = overlap->fixture->GetId();
+	event->sensorChildIndex = overlap->sensorChildIndex;
+	event->visitorChildIndex = overlap->childIndex;
+	++(*count);
+}
+
+// Remove an overlap and keep the touching overlaps at the front of the array.
+static void b2RemoveSensorOverlap(b2Sensor* sensor, int32 index)
+{
+	b2Assert(0 <= index && index < sensor->overlapCount);
+
+	b2SensorOverlap* overlaps = sensor->overlaps;
+	if (index < sensor->touchingCount)
+	{
+		--sensor->touchingCount;
+		overlaps[index] = overlaps[sensor->touchingCount];
+		index = sensor->touchingCount;
+	}
+
+	--sensor->overlapCount;
+	overlaps[index] = overlaps[sensor->overlapCount];
+}
+
+b2SensorManager::b2SensorManager(const b2Allocator* allocator)
+{
+	if (allocator)
+	{
+		m_arrayAllocator = *allocator;
+	}
+
+	m_sensorCapacity = 16;
+	m_sensorCount = 0;
+	m_sensors = (b2Sensor**)m_arrayAllocator.Allocate(m_sensorCapacity * sizeof(b2Sensor*));
+
+	m_beginEvents = nullptr;
+	m_beginCount = 0;
+	m_beginCapacity = 0;
+
+	m_endEvents = nullptr;
+	m_endCount = 0;
+	m_endCapacity = 0;
+	m_updateEndCount = 0;
+
+	m_allocator = nullptr;
+}
+
+b2SensorManager::~b2SensorManager()
+{
+	// The sensors live in the block allocator, only the overlap arrays use the memory callbacks.
+	for (int32 i = 0; i < m_sensorCount; ++i)
+	{
+		m_arrayAllocator.Free(m_sensors[i]->overlaps);
+	}
+
+	m_arrayAllocator.Free(m_sensors);
+	m_arrayAllocator.Free(m_beginEvents);
+	m_arrayAllocator.Free(m_endEvents);
+}
+
+b2Sensor* b2SensorManager::CreateSensor(b2Fixture* fixture)
+{
+	void* mem = m_allocator->Allocate(sizeof(b2Sensor));
+	b2Sensor* sensor = new (mem) b2Sensor;
+	sensor->fixture = fixture;
+	sensor->overlaps = nullptr;
+	sensor->overlapCount = 0;
+	sensor->overlapCapacity = 0;
+	sensor->touchingCount = 0;
+	sensor->beginIndex = 0;
+	sensor->beginCount = 0;
+	sensor->endIndex = 0;
+	sensor->endCount = 0;
+
+	if (m_sensorCount == m_sensorCapacity)
+	{
+		b2Sensor** oldSensors = m_sensors;
+		m_sensorCapacity *= 2;
+		m_sensors = (b2Sensor**)m_arrayAllocator.Allocate(m_sensorCapacity * sizeof(b2Sensor*));
+		memcpy(m_sensors, oldSensors, m_sensorCount * sizeof(b2Sensor*));
+		m_arrayAllocator.Free(oldSensors);
+	}
+
+	sensor->index = m_sensorCount;
+	m_sensors[m_sensorCount] = sensor;
+	++m_sensorCount;
+
+	return sensor;
+}
+
+void b2SensorManager::DestroySensor(b2Sensor* sensor)
+{
+	// The overlaps must be removed before calling this.
+	b2Assert(sensor->overlapCount == 0);
+
+	// Swap remove from the sensor array.
+	int32 index = sensor->index;
+	b2Assert(0 <= index && index < m_sensorCount && m_sensors[index] == sensor);
+	--m_sensorCount;
+	m_sensors[index] = m_sensors[m_sensorCount];
+	m_sensors[index]->index = index;
+
+	m_arrayAllocator.Free(sensor->overlaps);
+	sensor->~b2Sensor();
+	m_allocator->Free(sensor, sizeof(b2Sensor));
+}
+
+void b2SensorManager::AddPair(b2FixtureProxy* sensorProxy, b2FixtureProxy* visitorProxy, const b2ContactManager* contactManager)
+{
+	b2Fixture* sensorFixture = sensorProxy->fixture;
+	b2Fixture* visitor = visitorProxy->fixture;
+	b2Sensor* sensor = sensorFixture->m_sensor;
+	b2Assert(sensor != nullptr);
+
+	int32 sensorChildIndex = sensorProxy->childIndex;
+	int32 childIndex = visitorProxy->childIndex;
+
+	// Does the overlap already exist?
+	for (int32 i = 0; i < sensor->overlapCount; ++i)
+	{
+		const b2SensorOverlap* overlap = sensor->overlaps + i;
+		if (overlap->fixture == visitor && overlap->childIndex == childIndex &&
+			overlap->sensorChildIndex == sensorChildIndex)
+		{
+			return;
+		}
+	}
+
+	// Check user filtering.
+	if (contactManager->ShouldCollide(sensorFixture, visitor) == false)
+	{
+		return;
+	}
+
+	// Grow the overlap array as needed.
+	if (sensor->overlapCount == sensor->overlapCapacity)
+	{
+		b2SensorOverlap* oldOverlaps = sensor->overlaps;
+		sensor->overlapCapacity = sensor->overlapCapacity > 0 ? 2 * sensor->overlapCapacity : 4;
+		sensor->overlaps = (b2SensorOverlap*)m_arrayAllocator.Allocate(sensor->overlapCapacity * sizeof(b2SensorOverlap));
+		if (oldOverlaps)
+		{
+			memcpy(sensor->overlaps, oldOverlaps, sensor->overlapCount * sizeof(b2SensorOverlap));
+			m_arrayAllocator.Free(oldOverlaps);
+		}
+	}
+
+	// New overlaps are not touching until the next update.
+	b2SensorOverlap* overlap = sensor->overlaps + sensor->overlapCount;
+	overlap->fixture = visitor;
+	overlap->childIndex = childIndex;
+	overlap->sensorChildIndex = sensorChildIndex;
+	overlap->touching = false;
+	++sensor->overlapCount;
+
+	++visitor->m_visitCount;
+}
+
+void b2SensorManager::RemoveFixture(b2Fixture* fixture)
+{
+	b2Sensor* sensor = fixture->m_sensor;
+	if (sensor)
+	{
+		for (int32 i = 0; i < sensor->overlapCount; ++i)
+		{
+			if (i < sensor->touchingCount)
+			{
+				b2PushSensorEvent(&m_endEvents, &m_endCount, &m_endCapacity, m_arrayAllocator, sensor, sensor->overlaps + i);
+			}
+
+			--sensor->overlaps[i].fixture->m_visitCount;
+		}
+
+		sensor->overlapCount = 0;
+		sensor->touchingCount = 0;
+	}
+
+	// Visitors are not tracked per fixture, so only scan the sensors when
+	// this fixture is known to be referenced.
+	for (int32 i = 0; i < m_sensorCount && fixture->m_visitCount > 0; ++i)
+	{
+		b2Sensor* s = m_sensors[i];
+		int32 j = 0;
+		while (j < s->overlapCount)
+		{
+			if (s->overlaps[j].fixture == fixture)
+			{
+				if (s->overlaps[j].touching)
+				{
+					b2PushSensorEvent(&m_endEvents, &m_endCount, &m_endCapacity, m_arrayAllocator, s, s->overlaps + j);
+				}
+
+				b2RemoveSensorOverlap(s, j);
+				--fixture->m_visitCount;
+				continue;
+			}
+
+			++j;
+		}
+	}
+
+	b2Assert(fixture->m_visitCount == 0);
+}
+
+void b2SensorManager::RelocateFixture(b2Fixture* oldFixture, b2Fixture* newFixture)
+{
+	if (newFixture->m_sensor)
+	{
+		newFixture->m_sensor->fixture = newFixture;
+	}
+
+	int32 visitCount = newFixture->m_visitCount;
+	for (int32 i = 0; i < m_sensorCount && visitCount > 0; ++i)
+	{
+		b2Sensor* s = m_sensors[i];
+		for (int32 j = 0; j < s->overlapCount; ++j)
+		{
+			if (s->overlaps[j].fixture == oldFixture)
+			{
+				s->overlaps[j].fixture = newFixture;
+				--visitCount;
+			}
+		}
+	}
+}
+
+void b2SensorManager::Update(const b2BroadPhase* broadPhase)
+{
+	// Keep the end events of overlaps that were removed since the last update.
+	int32 removedCount = m_endCount - m_updateEndCount;
+	if (removedCount > 0 && m_updateEndCount > 0)
+	{
+		memmove(m_endEvents, m_endEvents + m_updateEndCount, removedCount * sizeof(b2SensorEvent));
+	}
+
+	m_beginCount = 0;
+	m_endCount = removedCount;
+
+	for (int32 i = 0; i < m_sensorCount; ++i)
+	{
+		b2Sensor* sensor = m_sensors[i];
+		sensor->beginIndex = m_beginCount;
+		sensor->endIndex = m_endCount;
+
+		b2Fixture* sensorFixture = sensor->fixture;
+		const b2Body* sensorBody = sensorFixture->GetBody();
+		const b2Shape* sensorShape = sensorFixture->GetShape();
+		const b2Transform& sensorTransform = sensorBody->GetTransform();
+		bool sensorActive = sensorBody->IsAwake() && sensorBody->GetType() != b2_staticBody;
+
+		bool reorder = false;
+		int32 j = 0;
+		while (j < sensor->overlapCount)
+		{
+			b2SensorOverlap* overlap = sensor->overlaps + j;
+			b2Fixture* visitor = overlap->fixture;
+			const b2Body* visitorBody = visitor->GetBody();
+			bool visitorActive = visitorBody->IsAwake() && visitorBody->GetType() != b2_staticBody;
+
+			// Nothing moved, so the overlap status cannot change.
+			if (sensorActive == false && visitorActive == false)
+			{
+				++j;
+				continue;
+			}
+
+			int32 proxyIdA = sensorFixture->m_proxies[overlap->sensorChildIndex].proxyId;
+			int32 proxyIdB = visitor->m_proxies[overlap->childIndex].proxyId;
+			if (broadPhase->TestOverlap(proxyIdA, proxyIdB) == false)
+			{
+				// The fat AABBs no longer overlap, drop the pair.
+				if (overlap->touching)
+				{
+					b2PushSensorEvent(&m_endEvents, &m_endCount, &m_endCapacity, m_arrayAllocator, sensor, overlap);
+				}
+
+				--visitor->m_visitCount;
+				b2RemoveSensorOverlap(sensor, j);
+				continue;
+			}
+
+			bool touching = b2TestOverlap(sensorShape, overlap->sensorChildIndex,
+										  visitor->GetShape(), overlap->childIndex,
+										  sensorTransform, visitorBody->GetTransform());
+
+			if (touching && overlap->touching == false)
+			{
+				b2PushSensorEvent(&m_beginEvents, &m_beginCount, &m_beginCapacity, m_arrayAllocator, sensor, overlap);
+				overlap->touching = true;
+				reorder = true;
+			}
+			else if (touching == false && overlap->touching)
+			{
+				b2PushSensorEvent(&m_endEvents, &m_endCount, &m_endCapacity, m_arrayAllocator, sensor, overlap);
+				overlap->touching = false;
+				reorder = true;
+			}
+
+			++j;
+		}
+
+		if (reorder)
+		{
+			// Move the touching overlaps to the front.
+			int32 touchingCount = 0;
+			for (int32 k = 0; k < sensor->overlapCount; ++k)
+			{
+				if (sensor->overlaps[k].touching)
+				{
+					b2SensorOverlap tmp = sensor->overlaps[touchingCount];
+					sensor->overlaps[touchingCount] = sensor->overlaps[k];
+					sensor->overlaps[k] = tmp;
+					++touchingCount;
+				}
+			}
+			sensor->touchingCount = touchingCount;
+		}
+
+		sensor->beginCount = m_beginCount - sensor->beginIndex;
+		sensor->endCount = m_endCount - sensor->endIndex;
+	}
+
+	m_updateEndCount = m_endCount;
+}
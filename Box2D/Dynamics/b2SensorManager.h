@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SENSOR_MANAGER_H
+#define B2_SENSOR_MANAGER_H
+
+#include "Box2D/Common/b2Settings.h"
+#include "Box2D/Common/b2HandleTable.h"
+
+class b2BlockAllocator;
+class b2BroadPhase;
+class b2ContactManager;
+class b2Fixture;
+struct b2FixtureProxy;
+
+/// A visitor fixture child that overlaps a sensor fixture child.
+struct b2SensorOverlap
+{
+	b2Fixture* fixture;		///< the visitor fixture
+	int32 childIndex;		///< the visitor child primitive index
+	int32 sensorChildIndex;	///< the sensor child primitive index
+	bool touching;			///< true if the shapes overlap (always true in the public overlap set)
+};
+
+/// A sensor event is reported when a visitor fixture begins or ends overlapping
+/// a sensor fixture. Events are valid until the next time step. Every begin event
+/// is followed by an end event, also when an overlap is removed by destroying,
+/// filtering or deactivating a fixture. The fixture pointers of such an event may
+/// be invalid, check the ids with b2World::GetFixture before using them.
+struct b2SensorEvent
+{
+	b2Fixture* sensor;
+	b2Fixture* visitor;
+	b2FixtureId sensorId;
+	b2FixtureId visitorId;
+	int32 sensorChildIndex;
+	int32 visitorChildIndex;
+};
+
+/// This is an internal structure. It holds the overlap state of a sensor fixture.
+/// The overlap array holds every visitor whose fat AABB overlaps the sensor. The
+/// first touchingCount overlaps are touching the sensor shape.
+struct b2Sensor
+{
+	b2Fixture* fixture;
+
+	b2SensorOverlap* overlaps;
+	int32 overlapCount;
+	int32 overlapCapacity;
+	int32 touchingCount;
+
+	// Ranges into the world event arrays for the last time step.
+	int32 beginIndex;
+	int32 beginCount;
+	int32 endIndex;
+	int32 endCount;
+
+	// Index in the sensor manager array.
+	int32 index;
+};
+
+// Delegate of b2ContactManager. Sensors do not create contacts. Instead the
+// broad-phase pairs of a sensor are kept in the sensor and tested for overlap
+// with a boolean shape test at the end of the time step.
+class b2SensorManager
+{
+public:
+	b2SensorManager(const b2Allocator* allocator = nullptr);
+	~b2SensorManager();
+
+	b2Sensor* CreateSensor(b2Fixture* fixture);
+	void DestroySensor(b2Sensor* sensor);
+
+	// Broad-phase callback (routed through b2ContactManager::AddPair).
+	void AddPair(b2FixtureProxy* sensorProxy, b2FixtureProxy* visitorProxy, const b2ContactManager* contactManager);
+
+	// Remove every overlap that involves this fixture, either as sensor or as visitor.
+	// Touching overlaps get an end event. This must be called before the fixture
+	// proxies are destroyed.
+	void RemoveFixture(b2Fixture* fixture);
+
+	// Replace the pointers to a fixture that was moved by world compaction.
+	void RelocateFixture(b2Fixture* oldFixture, b2Fixture* newFixture);
+
+	// Test the overlaps of sensors that have a moving participant and
+	// record the begin/end events.
+	void Update(const b2BroadPhase* broadPhase);
+
+	b2Sensor** m_sensors;
+	int32 m_sensorCount;
+	int32 m_sensorCapacity;
+
+	b2SensorEvent* m_beginEvents;
+	int32 m_beginCount;
+	int32 m_beginCapacity;
+
+	b2SensorEvent* m_endEvents;
+	int32 m_endCount;
+	int32 m_endCapacity;
+
+	// The end events written by the last update. The events after these were
+	// added by RemoveFixture and are carried over to the next update.
+	int32 m_updateEndCount;
+
+	// The sensors live in the block allocator, the arrays use the memory callbacks.
+	b2BlockAllocator* m_allocator;
+	b2Allocator m_arrayAllocator;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Dynamics/b2StaticGeometry.h"
+#include "Box2D/Collision/Shapes/b2Shape.h"
+#include <new>
+#include <string.h>
+
+b2StaticGeometry* b2StaticGeometry::Create()
+{
+	void* mem = b2Alloc(sizeof(b2StaticGeometry));
+	return new (mem) b2StaticGeometry;
+}
+
+b2StaticGeometry::b2StaticGeometry()
+{
+	m_shapes = nullptr;
+	m_shapeCount = 0;
+	m_shapeCapacity = 0;
+
+	m_proxyIds = nullptr;
+	m_proxyCount = 0;
+	m_proxyCapacity = 0;
+}
+
+b2StaticGeometry::~b2StaticGeometry()
+{
+	// The shape blocks are released with the allocator. Chain shapes own heap memory.
+	for (int32 i = 0; i < m_shapeCount; ++i)
+	{
+		b2Shape* shape = (b2Shape*)m_shapes[i].def.shape;
+		shape->~b2Shape();
+	}
+
+	b2Free(m_shapes);
+	b2Free(m_proxyIds);
+}
+
+void b2StaticGeometry::Retain()
+{
+	m_refCount.Retain();
+}
+
+void b2StaticGeometry::Release()
+{
+	if (m_refCount.Release())
+	{
+		this->~b2StaticGeometry();
+		b2Free(this);
+	}
+}
+
+int32 b2StaticGeometry::AddShape(const b2FixtureDef* def)
+{
+	// Attached geometry is read by other worlds and threads, and the worlds sized
+	// their proxy user data from the tree when it was attached.
+	b2Assert(m_refCount.GetCount() == 1);
+	if (m_refCount.GetCount() != 1)
+	{
+		return -1;
+	}
+
+	b2Assert(def->shape != nullptr || def->sharedShape != nullptr);
+
+	if (m_shapeCount == m_shapeCapacity)
+	{
+		b2StaticShape* oldShapes = m_shapes;
+		m_shapeCapacity = m_shapeCapacity > 0 ? 2 * m_shapeCapacity : 16;
+		m_shapes = (b2StaticShape*)b2Alloc(m_shapeCapacity * sizeof(b2StaticShape));
+		if (oldShapes)
+		{
+			memcpy(m_shapes, oldShapes, m_shapeCount * sizeof(b2StaticShape));
+			b2Free(oldShapes);
+		}
+	}
+
+	const b2Shape* source = def->sharedShape ? def->sharedShape->GetShape() : def->shape;
+	b2Shape* shape = source->Clone(&m_allocator);
+	int32 childCount = shape->GetChildCount();
+
+	b2StaticShape* staticShape = m_shapes + m_shapeCount;
+	staticShape->def = *def;
+	staticShape->def.shape = shape;
+	staticShape->def.sharedShape = nullptr;
+	staticShape->def.density = 0.0f;
+	staticShape->proxyIndex = m_proxyCount;
+
+	if (m_proxyCount + childCount > m_proxyCapacity)
+	{
+		int32* oldProxyIds = m_proxyIds;
+		m_proxyCapacity = b2Max(2 * m_proxyCapacity, m_proxyCount + childCount);
+		m_proxyIds = (int32*)b2Alloc(m_proxyCapacity * sizeof(int32));
+		if (oldProxyIds)
+		{
+			memcpy(m_proxyIds, oldProxyIds, m_proxyCount * sizeof(int32));
+			b2Free(oldProxyIds);
+		}
+	}
+
+	b2Transform xf;
+	xf.SetIdentity();
+	for (int32 i = 0; i < childCount; ++i)
+	{
+		b2AABB aabb;
+		shape->ComputeAABB(&aabb, xf, i);
+		m_proxyIds[m_proxyCount] = m_tree.CreateProxy(aabb, nullptr);
+		++m_proxyCount;
+	}
+
+	return m_shapeCount++;
+}
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_STATIC_GEOMETRY_H
+#define B2_STATIC_GEOMETRY_H
+
+#include "Box2D/Common/b2BlockAllocator.h"
+#include "Box2D/Collision/b2DynamicTree.h"
+#include "Box2D/Common/b2RefCount.h"
+#include "Box2D/Dynamics/b2Fixture.h"
+
+/// A set of static shapes with a prebuilt broad-phase tree that many worlds can share,
+/// see b2World::AttachStaticGeometry. Each world only keeps a fixture per shape,
+/// the shapes and the tree are not copied. The shapes are in world coordinates.
+/// The geometry is reference counted. Worlds hold a reference while it is attached.
+/// Once attached the geometry is immutable, so worlds on different threads may use it.
+class b2StaticGeometry
+{
+public:
+	/// Create an empty geometry with a reference count of one.
+	static b2StaticGeometry* Create();
+
+	/// Add a reference, see b2RefCount.
+	void Retain();
+
+	/// Remove a reference. The geometry is destroyed when the last reference is removed.
+	void Release();
+
+	/// Add a shape. The shape is cloned. The fixture definition provides the material,
+	/// filter and user data of the fixture created in each world. The density is ignored.
+	/// @return the shape index, this is the order of the fixtures in the world. Returns -1
+	/// if the geometry has more than one reference.
+	/// @warning this can only be called while the geometry has a single reference.
+	int32 AddShape(const b2FixtureDef* def);
+
+	/// Get the number of shapes.
+	int32 GetShapeCount() const;
+
+	/// Get a shape.
+	const b2Shape* GetShape(int32 index) const;
+
+	/// Get the tree of the shape children. The user data of a proxy is unused.
+	const b2DynamicTree& GetTree() const;
+
+	/// Get the current reference count.
+	int32 GetReferenceCount() const;
+
+private:
+
+	friend class b2World;
+
+	struct b2StaticShape
+	{
+		b2FixtureDef def;
+		int32 proxyIndex;
+	};
+
+	b2StaticGeometry();
+	~b2StaticGeometry();
+
+	b2BlockAllocator m_allocator;
+	b2DynamicTree m_tree;
+
+	b2StaticShape* m_shapes;
+	int32 m_shapeCount;
+	int32 m_shapeCapacity;
+
+	// Tree proxies of the shape children, see b2StaticShape::proxyIndex.
+	int32* m_proxyIds;
+	int32 m_proxyCount;
+	int32 m_proxyCapacity;
+
+	b2RefCount m_refCount;
+};
+
+inline int32 b2StaticGeometry::GetShapeCount() const
+{
+	return m_shapeCount;
+}
+
+inline const b2Shape* b2StaticGeometry::GetShape(int32 index) const
+{
+	b2Assert(0 <= index && index < m_shapeCount);
+	return m_shapes[index].def.shape;
+}
+
+inline const b2DynamicTree& b2StaticGeometry::GetTree() const
+{
+	return m_tree;
+}
+
+inline int32 b2StaticGeometry::GetReferenceCount() const
+{
+	return m_refCount.GetCount();
+}
+
+#endif
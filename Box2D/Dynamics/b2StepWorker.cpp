@@ -0,0 +1,95 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Dynamics/b2StepWorker.h"
+#include "Box2D/Dynamics/b2World.h"
+
+b2StepWorker::b2StepWorker(b2World* world)
+{
+	m_world = world;
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+	m_busy = false;
+	m_quit = false;
+
+	// Start the thread last, it reads the members.
+	m_thread = std::thread(&b2StepWorker::Run, this);
+}
+
+b2StepWorker::~b2StepWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		b2Assert(m_busy == false);
+		m_quit = true;
+	}
+
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+void b2StepWorker::Start(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		b2Assert(m_busy == false);
+		m_timeStep = timeStep;
+		m_velocityIterations = velocityIterations;
+		m_positionIterations = positionIterations;
+		m_busy = true;
+	}
+
+	m_condition.notify_all();
+}
+
+void b2StepWorker::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_busy)
+	{
+		m_condition.wait(lock);
+	}
+}
+
+void b2StepWorker::Run()
+{
+	for (;;)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_busy == false && m_quit == false)
+		{
+			m_condition.wait(lock);
+		}
+
+		if (m_quit)
+		{
+			return;
+		}
+
+		// The caller does not touch the world until Wait returns.
+		lock.unlock();
+		m_world->Step(m_timeStep, m_velocityIterations, m_positionIterations);
+		m_world->WriteBodyStates(m_world->m_stateIndex ^ 1);
+		lock.lock();
+
+		m_busy = false;
+		lock.unlock();
+		m_condition.notify_all();
+	}
+}
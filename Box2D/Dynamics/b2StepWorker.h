@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_STEP_WORKER_H
+#define B2_STEP_WORKER_H
+
+#include "Box2D/Common/b2Math.h"
+#include "Box2D/Dynamics/b2WorldCallbacks.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class b2World;
+
+/// This is an internal structure. It holds a change that was queued during an
+/// asynchronous time step and is applied by b2World::Sync.
+struct b2WorldCommand
+{
+	enum Type
+	{
+		e_applyForce,
+		e_applyLinearImpulse,
+		e_applyTorque,
+		e_setTransform,
+		e_setVelocity,
+		e_destroyBody,
+		e_function
+	};
+
+	Type type;
+	uint32 bodyId;
+	b2Vec2 vector;		// force, impulse, position or linear velocity
+	b2Vec2 point;		// the world point of a force or impulse
+	float32 scalar;		// torque, angle or angular velocity
+	b2WorldCommandFcn* fcn;
+	void* context;
+};
+
+// Runs the asynchronous time steps of a world on a thread that lives as long as
+// the worker. Start hands a step to the thread and Wait blocks until it is done.
+class b2StepWorker
+{
+public:
+	b2StepWorker(b2World* world);
+	~b2StepWorker();
+
+	void Start(float32 timeStep, int32 velocityIterations, int32 positionIterations);
+	void Wait();
+
+private:
+
+	void Run();
+
+	b2World* m_world;
+
+	float32 m_timeStep;
+	int32 m_velocityIterations;
+	int32 m_positionIterations;
+
+	// Guarded by the mutex.
+	bool m_busy;
+	bool m_quit;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::thread m_thread;
+};
+
+#endif
@@ -21,7 +21,7 @@
 
 #include "Box2D/Common/b2Math.h"
 
-/// Profiling data. Times are in milliseconds.
+/// Profiling data. Times are in milliseconds, sizes are in bytes.
 struct b2Profile
 {
 	float32 step;
@@ -32,6 +32,17 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+	float32 sensors;
+	int32 stackAllocation;	///< the largest stack allocator usage so far
+	int32 allocations;		///< the number of heap allocations in the last time step
+	int32 gjkCalls;			///< the number of b2Distance calls in the last time step
+	int32 gjkIters;
+	int32 gjkMaxIters;
+	int32 toiCalls;			///< the number of b2TimeOfImpact calls in the last time step
+	int32 toiIters;
+	int32 toiMaxIters;
+	int32 toiRootIters;
+	int32 toiMaxRootIters;
 };
 
 /// This is an internal structure.
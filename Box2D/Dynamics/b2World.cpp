@@ -20,6 +20,10 @@
 #include "Box2D/Dynamics/b2Body.h"
 #include "Box2D/Dynamics/b2Fixture.h"
 #include "Box2D/Dynamics/b2Island.h"
+#include "Box2D/Dynamics/b2QuerySnapshot.h"
+#include "Box2D/Dynamics/b2StaticGeometry.h"
+#include "Box2D/Dynamics/b2StepWorker.h"
+#include "Box2D/Dynamics/Joints/b2GearJoint.h"
 #include "Box2D/Dynamics/Joints/b2PulleyJoint.h"
 #include "Box2D/Dynamics/Contacts/b2Contact.h"
 #include "Box2D/Dynamics/Contacts/b2ContactSolver.h"
@@ -34,15 +38,75 @@
 #include "Box2D/Common/b2Timer.h"
 #include <new>
 
-b2World::b2World(const b2Vec2& gravity)
+// Bytes of the state arrays per body, see b2BodyArrays.
+static const int32 b2_bodyStateSize = sizeof(b2Transform) + sizeof(b2Sweep) + 2 * sizeof(b2Vec2) + 4 * sizeof(float32);
+
+extern b2ContactFilter b2_defaultFilter;
+
+b2World::b2World(const b2Vec2& gravity, int32 stackSize, const b2Allocator* allocator)
+	: m_ownBlockAllocator(allocator)
+	, m_ownStackAllocator(stackSize, allocator)
+	, m_contactManager(allocator)
+	, m_ignorePairs(allocator)
+	, m_bodyIds(allocator)
+	, m_fixtureIds(allocator)
+	, m_jointIds(allocator)
+{
+	b2WorldDef def;
+	def.gravity = gravity;
+	def.allocator = allocator;
+	Initialize(&def);
+}
+
+b2World::b2World(const b2WorldDef* def)
+	: m_ownBlockAllocator(def->allocator, def->chunkSize)
+	, m_ownStackAllocator(def->stackSize > 0 ? def->stackSize : b2_stackSize, def->allocator)
+	, m_contactManager(def->allocator)
+	, m_ignorePairs(def->allocator)
+	, m_bodyIds(def->allocator)
+	, m_fixtureIds(def->allocator)
+	, m_jointIds(def->allocator)
+{
+	Initialize(def);
+
+	b2Assert(def->bodyCapacity >= 0 && def->fixtureCapacity >= 0 && def->proxyCapacity >= 0);
+	b2Assert(def->contactCapacity >= 0 && def->jointCapacity >= 0 && def->stackSize >= 0);
+
+	ReserveBodies(def->bodyCapacity);
+	ReserveFixtures(def->fixtureCapacity);
+	ReserveProxies(def->proxyCapacity > 0 ? def->proxyCapacity : def->fixtureCapacity);
+	ReserveContacts(def->contactCapacity);
+	ReserveJoints(def->jointCapacity);
+
+	if (def->stackSize > 0)
+	{
+		ReserveStack(def->stackSize);
+	}
+}
+
+void b2World::Initialize(const b2WorldDef* def)
 {
+	// Memory from one callback would be given to the other's fallback.
+	b2Assert(def->allocator == nullptr || (def->allocator->allocFcn == nullptr) == (def->allocator->freeFcn == nullptr));
+	if (def->allocator)
+	{
+		m_allocator = *def->allocator;
+	}
+
+	m_blockAllocator = def->blockAllocator ? def->blockAllocator : &m_ownBlockAllocator;
+	m_stackAllocator = def->stackAllocator ? def->stackAllocator : &m_ownStackAllocator;
+
 	m_destructionListener = nullptr;
+	m_relocationListener = nullptr;
 	g_debugDraw = nullptr;
 
 	m_bodyList = nullptr;
 	m_jointList = nullptr;
 
+	m_bodies = nullptr;
 	m_bodyCount = 0;
+	m_bodyCapacity = 0;
+	memset(&m_bodyArrays, 0, sizeof(b2BodyArrays));
 	m_jointCount = 0;
 
 	m_warmStarting = true;
@@ -52,19 +116,78 @@ b2World::b2World(const b2Vec2& gravity)
 	m_stepComplete = true;
 
 	m_allowSleep = true;
-	m_gravity = gravity;
+	m_gravity = def->gravity;
 
 	m_flags = e_clearForces;
 
 	m_inv_dt0 = 0.0f;
 
-	m_contactManager.m_allocator = &m_blockAllocator;
+	m_compactionBudget = 0;
+	m_compactionCursor = 0;
+	m_compactionStack = nullptr;
+	m_compactionStackCount = 0;
+	m_compactionStackCapacity = 0;
+
+	m_jointBreakEvents = nullptr;
+	m_jointBreakEventCount = 0;
+	m_jointBreakEventCapacity = 0;
+
+	m_staticGeometry = nullptr;
+	m_staticGeometryBody = nullptr;
+	m_staticUserData = nullptr;
+
+	m_worker = nullptr;
+	m_stepping = false;
+	m_bodyStates[0] = nullptr;
+	m_bodyStates[1] = nullptr;
+	m_bodyStateCapacity[0] = 0;
+	m_bodyStateCapacity[1] = 0;
+	m_stateIndex = 0;
+
+	m_commands = nullptr;
+	m_commandCount = 0;
+	m_commandCapacity = 0;
+
+	m_querySnapshot = nullptr;
+	m_spareSnapshot = nullptr;
+	m_snapshotVersion = 0;
+
+	m_contactManager.m_sensorManager.m_allocator = m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
 
 b2World::~b2World()
 {
+	// Stop the worker before anything is destroyed. Queued commands are dropped.
+	if (m_worker)
+	{
+		m_worker->Wait();
+		m_worker->~b2StepWorker();
+		m_allocator.Free(m_worker);
+	}
+
+	m_allocator.Free(m_bodyStates[0]);
+	m_allocator.Free(m_bodyStates[1]);
+	m_allocator.Free(m_commands);
+
+	SetQuerySnapshots(false);
+
+	// A shared block allocator outlives this world, so all blocks are given back.
+	// Otherwise the blocks go away with the allocator.
+	bool sharedBlocks = m_blockAllocator != &m_ownBlockAllocator;
+
+	if (sharedBlocks)
+	{
+		b2Joint* j = m_jointList;
+		while (j)
+		{
+			b2Joint* jNext = j->m_next;
+			b2Joint::Destroy(j, m_blockAllocator);
+			j = jNext;
+		}
+	}
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -76,12 +199,42 @@ b2World::~b2World()
 		{
 			b2Fixture* fNext = f->m_next;
 			f->m_proxyCount = 0;
-			f->Destroy(&m_blockAllocator);
+			f->Destroy(m_blockAllocator);
+
+			if (sharedBlocks)
+			{
+				if (f->m_sensor)
+				{
+					f->m_sensor->overlapCount = 0;
+					m_contactManager.m_sensorManager.DestroySensor(f->m_sensor);
+				}
+
+				f->~b2Fixture();
+				m_blockAllocator->Free(f, sizeof(b2Fixture));
+			}
+
 			f = fNext;
 		}
 
+		if (sharedBlocks)
+		{
+			b->~b2Body();
+			m_blockAllocator->Free(b, sizeof(b2Body));
+		}
+
 		b = bNext;
 	}
+
+	m_allocator.Free(m_bodies);
+	m_allocator.Free(m_bodyArrays.transforms);
+	m_allocator.Free(m_compactionStack);
+	m_allocator.Free(m_jointBreakEvents);
+	m_allocator.Free(m_staticUserData);
+
+	if (m_staticGeometry)
+	{
+		m_staticGeometry->Release();
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -92,6 +245,38 @@ void b2World::SetDestructionListener(b2DestructionListener* listener)
 void b2World::SetContactFilter(b2ContactFilter* filter)
 {
 	m_contactManager.m_contactFilter = filter;
+
+	// The default filter is inlined by the contact manager.
+	if (filter == &b2_defaultFilter)
+	{
+		m_contactManager.m_filterMode = b2ContactManager::e_defaultFilter;
+	}
+	else
+	{
+		m_contactManager.m_filterMode = b2ContactManager::e_userFilter;
+	}
+}
+
+void b2World::SetContactFilterFunction(b2ContactFilterFcn* fcn, void* context)
+{
+	m_contactManager.m_contactFilter = &b2_defaultFilter;
+	m_contactManager.m_contactFilterFcn = fcn;
+	m_contactManager.m_contactFilterContext = context;
+	m_contactManager.m_filterMode = fcn ? b2ContactManager::e_functionFilter : b2ContactManager::e_defaultFilter;
+}
+
+void b2World::SetLayerCollisionMatrix(const uint32* matrix)
+{
+	m_contactManager.m_contactFilter = &b2_defaultFilter;
+	if (matrix)
+	{
+		memcpy(m_contactManager.m_layerMatrix, matrix, sizeof(m_contactManager.m_layerMatrix));
+		m_contactManager.m_filterMode = b2ContactManager::e_layerFilter;
+	}
+	else
+	{
+		m_contactManager.m_filterMode = b2ContactManager::e_defaultFilter;
+	}
 }
 
 void b2World::SetContactListener(b2ContactListener* listener)
@@ -99,6 +284,149 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	m_contactManager.m_contactListener = listener;
 }
 
+void b2World::SetRelocationListener(b2RelocationListener* listener)
+{
+	m_relocationListener = listener;
+	m_contactManager.m_relocationListener = listener;
+}
+
+void b2World::SetCompactionBudget(int32 bodyCount)
+{
+	b2Assert(bodyCount >= 0);
+	m_compactionBudget = bodyCount;
+
+	if (m_compactionBudget > 0)
+	{
+		ReserveCompactionStack(m_bodyCapacity);
+	}
+}
+
+// The bodies left on the stack by a slice are kept as handles, since they
+// may be destroyed before the next slice.
+void b2World::ReserveCompactionStack(int32 count)
+{
+	if (count <= m_compactionStackCapacity)
+	{
+		return;
+	}
+
+	b2BodyId* oldStack = m_compactionStack;
+	m_compactionStackCapacity = count;
+	m_compactionStack = (b2BodyId*)m_allocator.Allocate(m_compactionStackCapacity * sizeof(b2BodyId));
+	if (oldStack)
+	{
+		memcpy(m_compactionStack, oldStack, m_compactionStackCount * sizeof(b2BodyId));
+		m_allocator.Free(oldStack);
+	}
+}
+
+void b2World::ReserveBodies(int32 bodyCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	if (bodyCount > m_bodyCapacity)
+	{
+		ResizeBodies(bodyCount);
+
+		if (m_compactionBudget > 0)
+		{
+			ReserveCompactionStack(m_bodyCapacity);
+		}
+	}
+
+	m_bodyIds.Reserve(bodyCount);
+	m_blockAllocator->Reserve(sizeof(b2Body), bodyCount - m_bodyCount);
+}
+
+void b2World::ReserveFixtures(int32 fixtureCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	int32 count = fixtureCount - m_fixtureIds.GetCount();
+	m_fixtureIds.Reserve(fixtureCount);
+	m_blockAllocator->Reserve(sizeof(b2Fixture), count);
+	m_blockAllocator->Reserve(sizeof(b2FixtureProxy), count);
+}
+
+void b2World::ReserveJoints(int32 jointCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_jointIds.Reserve(jointCount);
+}
+
+void b2World::ReserveContacts(int32 contactCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.Reserve(contactCount);
+}
+
+void b2World::ReserveContacts(b2Shape::Type typeA, b2Shape::Type typeB, int32 contactCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	int32 arrayIndex = b2Contact::GetArrayIndex(typeA, typeB);
+	if (arrayIndex != -1)
+	{
+		m_contactManager.ReserveContacts(arrayIndex, contactCount);
+	}
+}
+
+void b2World::ReserveProxies(int32 proxyCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.Reserve(proxyCount);
+}
+
+void b2World::ReserveStack(int32 size)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_stackAllocator->Reserve(size);
+}
+
+void b2World::SetAllocationCheck(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_checkAllocations;
+	}
+	else
+	{
+		m_flags &= ~e_checkAllocations;
+	}
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
 	g_debugDraw = debugDraw;
@@ -112,8 +440,15 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 		return nullptr;
 	}
 
-	void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+	// The body writes its state at the end of the arrays.
+	if (m_bodyCount == m_bodyCapacity)
+	{
+		ResizeBodies(m_bodyCapacity > 0 ? 2 * m_bodyCapacity : 64);
+	}
+
+	void* mem = m_blockAllocator->Allocate(sizeof(b2Body));
 	b2Body* b = new (mem) b2Body(def, this);
+	b->m_id = m_bodyIds.Create(b);
 
 	// Add to world doubly linked list.
 	b->m_prev = nullptr;
@@ -123,6 +458,10 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 		m_bodyList->m_prev = b;
 	}
 	m_bodyList = b;
+
+	// Append to the body array.
+	b2Assert(b->m_worldIndex == m_bodyCount);
+	m_bodies[m_bodyCount] = b;
 	++m_bodyCount;
 
 	return b;
@@ -155,6 +494,9 @@ void b2World::DestroyBody(b2Body* b)
 	}
 	b->m_jointList = nullptr;
 
+	// Delete the remaining collision ignore pairs.
+	m_ignorePairs.RemoveBody(b);
+
 	// Delete the attached contacts.
 	b2ContactEdge* ce = b->m_contactList;
 	while (ce)
@@ -164,6 +506,14 @@ void b2World::DestroyBody(b2Body* b)
 		m_contactManager.Destroy(ce0->contact);
 	}
 	b->m_contactList = nullptr;
+	m_contactManager.DestroyPairs(b, nullptr);
+
+	// Remove the static tree before its fixtures, so its trigger exit events
+	// are cleared with the fixtures.
+	if (b == m_staticGeometryBody)
+	{
+		m_contactManager.m_broadPhase.SetStaticTree(nullptr, nullptr);
+	}
 
 	// Delete the attached fixtures. This destroys broad-phase proxies.
 	b2Fixture* f = b->m_fixtureList;
@@ -177,10 +527,26 @@ void b2World::DestroyBody(b2Body* b)
 			m_destructionListener->SayGoodbye(f0);
 		}
 
-		f0->DestroyProxies(&m_contactManager.m_broadPhase);
-		f0->Destroy(&m_blockAllocator);
+		m_contactManager.m_sensorManager.RemoveFixture(f0);
+		if (f0->m_sensor)
+		{
+			m_contactManager.m_sensorManager.DestroySensor(f0->m_sensor);
+			f0->m_sensor = nullptr;
+		}
+
+		if (f0->m_shared)
+		{
+			f0->m_proxyCount = 0;
+		}
+		else
+		{
+			f0->DestroyProxies(&m_contactManager.m_broadPhase);
+		}
+		f0->ClearTriggerEvents(&m_contactManager.m_broadPhase);
+		m_fixtureIds.Destroy(f0->m_id);
+		f0->Destroy(m_blockAllocator);
 		f0->~b2Fixture();
-		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+		m_blockAllocator->Free(f0, sizeof(b2Fixture));
 
 		b->m_fixtureList = f;
 		b->m_fixtureCount -= 1;
@@ -188,6 +554,16 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = nullptr;
 	b->m_fixtureCount = 0;
 
+	// Detach the static geometry.
+	if (b == m_staticGeometryBody)
+	{
+		m_allocator.Free(m_staticUserData);
+		m_staticUserData = nullptr;
+		m_staticGeometry->Release();
+		m_staticGeometry = nullptr;
+		m_staticGeometryBody = nullptr;
+	}
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -204,9 +580,154 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	// Swap remove from the body array.
+	int32 index = b->m_worldIndex;
+	b2Assert(0 <= index && index < m_bodyCount && m_bodies[index] == b);
 	--m_bodyCount;
+	m_bodies[index] = m_bodies[m_bodyCount];
+	m_bodies[index]->m_worldIndex = index;
+
+	b2BodyArrays* arrays = &m_bodyArrays;
+	arrays->transforms[index] = arrays->transforms[m_bodyCount];
+	arrays->sweeps[index] = arrays->sweeps[m_bodyCount];
+	arrays->linearVelocities[index] = arrays->linearVelocities[m_bodyCount];
+	arrays->angularVelocities[index] = arrays->angularVelocities[m_bodyCount];
+	arrays->forces[index] = arrays->forces[m_bodyCount];
+	arrays->torques[index] = arrays->torques[m_bodyCount];
+	arrays->invMasses[index] = arrays->invMasses[m_bodyCount];
+	arrays->invIs[index] = arrays->invIs[m_bodyCount];
+
+	m_bodyIds.Destroy(b->m_id);
 	b->~b2Body();
-	m_blockAllocator.Free(b, sizeof(b2Body));
+	m_blockAllocator->Free(b, sizeof(b2Body));
+}
+
+void b2World::ResizeBodies(int32 capacity)
+{
+	b2Assert(capacity >= m_bodyCount);
+
+	b2Body** oldBodies = m_bodies;
+	b2BodyArrays oldArrays = m_bodyArrays;
+
+	m_bodyCapacity = capacity;
+	m_bodies = (b2Body**)m_allocator.Allocate(capacity * sizeof(b2Body*));
+
+	char* mem = (char*)m_allocator.Allocate(capacity * b2_bodyStateSize);
+	b2BodyArrays* arrays = &m_bodyArrays;
+	arrays->transforms = (b2Transform*)mem;
+	mem += capacity * sizeof(b2Transform);
+	arrays->sweeps = (b2Sweep*)mem;
+	mem += capacity * sizeof(b2Sweep);
+	arrays->linearVelocities = (b2Vec2*)mem;
+	mem += capacity * sizeof(b2Vec2);
+	arrays->angularVelocities = (float32*)mem;
+	mem += capacity * sizeof(float32);
+	arrays->forces = (b2Vec2*)mem;
+	mem += capacity * sizeof(b2Vec2);
+	arrays->torques = (float32*)mem;
+	mem += capacity * sizeof(float32);
+	arrays->invMasses = (float32*)mem;
+	mem += capacity * sizeof(float32);
+	arrays->invIs = (float32*)mem;
+
+	if (oldBodies)
+	{
+		int32 count = m_bodyCount;
+		memcpy(m_bodies, oldBodies, count * sizeof(b2Body*));
+		memcpy(arrays->transforms, oldArrays.transforms, count * sizeof(b2Transform));
+		memcpy(arrays->sweeps, oldArrays.sweeps, count * sizeof(b2Sweep));
+		memcpy(arrays->linearVelocities, oldArrays.linearVelocities, count * sizeof(b2Vec2));
+		memcpy(arrays->angularVelocities, oldArrays.angularVelocities, count * sizeof(float32));
+		memcpy(arrays->forces, oldArrays.forces, count * sizeof(b2Vec2));
+		memcpy(arrays->torques, oldArrays.torques, count * sizeof(float32));
+		memcpy(arrays->invMasses, oldArrays.invMasses, count * sizeof(float32));
+		memcpy(arrays->invIs, oldArrays.invIs, count * sizeof(float32));
+		m_allocator.Free(oldBodies);
+		m_allocator.Free(oldArrays.transforms);
+	}
+}
+
+b2Body* b2World::AttachStaticGeometry(b2StaticGeometry* geometry)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return nullptr;
+	}
+
+	b2Assert(m_staticGeometry == nullptr);
+	if (m_staticGeometry)
+	{
+		return nullptr;
+	}
+
+	b2BodyDef bd;
+	b2Body* body = CreateBody(&bd);
+
+	geometry->Retain();
+	m_staticGeometry = geometry;
+	m_staticGeometryBody = body;
+
+	const b2DynamicTree* tree = &geometry->m_tree;
+	m_staticUserData = (void**)m_allocator.Allocate(tree->GetNodeCapacity() * sizeof(void*));
+
+	// Create the fixtures in reverse, so the fixture list is in shape order.
+	for (int32 i = geometry->m_shapeCount - 1; i >= 0; --i)
+	{
+		const b2StaticGeometry::b2StaticShape* shape = geometry->m_shapes + i;
+
+		void* memory = m_blockAllocator->Allocate(sizeof(b2Fixture));
+		b2Fixture* f = new (memory) b2Fixture;
+		f->Create(m_blockAllocator, body, &shape->def, true);
+		f->m_id = m_fixtureIds.Create(f);
+
+		if (f->m_isSensor)
+		{
+			f->m_sensor = m_contactManager.m_sensorManager.CreateSensor(f);
+		}
+
+		// The proxies are in the tree of the geometry.
+		f->m_proxyCount = f->m_shape->GetChildCount();
+		for (int32 j = 0; j < f->m_proxyCount; ++j)
+		{
+			b2FixtureProxy* proxy = f->m_proxies + j;
+			int32 proxyId = geometry->m_proxyIds[shape->proxyIndex + j];
+			f->m_shape->ComputeAABB(&proxy->aabb, body->Transform(), j);
+			proxy->fixture = f;
+			proxy->childIndex = j;
+			proxy->proxyId = proxyId + b2BroadPhase::e_staticProxy;
+			m_staticUserData[proxyId] = proxy;
+		}
+
+		f->m_next = body->m_fixtureList;
+		body->m_fixtureList = f;
+		++body->m_fixtureCount;
+	}
+
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	broadPhase->SetStaticTree(tree, m_staticUserData);
+
+	// Existing proxies only look for the static proxies when they move.
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				broadPhase->TouchProxy(f->m_proxies[j].proxyId);
+			}
+		}
+	}
+
+	m_flags |= e_newFixture;
+
+	return body;
 }
 
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
@@ -217,7 +738,8 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 		return nullptr;
 	}
 
-	b2Joint* j = b2Joint::Create(def, &m_blockAllocator);
+	b2Joint* j = b2Joint::Create(def, m_blockAllocator);
+	j->m_id = m_jointIds.Create(j);
 
 	// Connect to the world list.
 	j->m_prev = nullptr;
@@ -250,18 +772,8 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 	// If the joint prevents collisions, then flag any contacts for filtering.
 	if (def->collideConnected == false)
 	{
-		b2ContactEdge* edge = bodyB->GetContactList();
-		while (edge)
-		{
-			if (edge->other == bodyA)
-			{
-				// Flag the contact for filtering at the next time step (where either
-				// body is awake).
-				edge->contact->FlagForFiltering();
-			}
-
-			edge = edge->next;
-		}
+		m_ignorePairs.Add(bodyA, bodyB);
+		FlagContactsForFiltering(bodyA, bodyB);
 	}
 
 	// Note: creating a joint doesn't wake the bodies.
@@ -341,7 +853,8 @@ void b2World::DestroyJoint(b2Joint* j)
 	j->m_edgeB.prev = nullptr;
 	j->m_edgeB.next = nullptr;
 
-	b2Joint::Destroy(j, &m_blockAllocator);
+	m_jointIds.Destroy(j->m_id);
+	b2Joint::Destroy(j, m_blockAllocator);
 
 	b2Assert(m_jointCount > 0);
 	--m_jointCount;
@@ -349,43 +862,431 @@ void b2World::DestroyJoint(b2Joint* j)
 	// If the joint prevents collisions, then flag any contacts for filtering.
 	if (collideConnected == false)
 	{
-		b2ContactEdge* edge = bodyB->GetContactList();
-		while (edge)
-		{
-			if (edge->other == bodyA)
-			{
-				// Flag the contact for filtering at the next time step (where either
-				// body is awake).
-				edge->contact->FlagForFiltering();
-			}
-
-			edge = edge->next;
-		}
+		m_ignorePairs.Remove(bodyA, bodyB);
+		FlagContactsForFiltering(bodyA, bodyB);
 	}
 }
 
-//
-void b2World::SetAllowSleeping(bool flag)
+void b2World::IgnoreCollision(b2Body* bodyA, b2Body* bodyB)
 {
-	if (flag == m_allowSleep)
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
 	{
 		return;
 	}
 
-	m_allowSleep = flag;
-	if (m_allowSleep == false)
+	m_ignorePairs.Add(bodyA, bodyB);
+	FlagContactsForFiltering(bodyA, bodyB);
+}
+
+void b2World::RestoreCollision(b2Body* bodyA, b2Body* bodyB)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
-		{
-			b->SetAwake(true);
-		}
+		return;
 	}
+
+	m_ignorePairs.Remove(bodyA, bodyB);
+	FlagContactsForFiltering(bodyA, bodyB);
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+bool b2World::IsCollisionIgnored(const b2Body* bodyA, const b2Body* bodyB) const
 {
-	m_profile.solveInit = 0.0f;
+	return bodyA->ShouldCollideConnected(bodyB) == false;
+}
+
+void b2World::FlagContactsForFiltering(b2Body* bodyA, b2Body* bodyB)
+{
+	b2ContactEdge* edge = bodyB->GetContactList();
+	while (edge)
+	{
+		if (edge->other == bodyA)
+		{
+			// Flag the contact for filtering at the next time step (where either
+			// body is awake).
+			edge->contact->FlagForFiltering();
+		}
+
+		edge = edge->next;
+	}
+
+	m_contactManager.FlagPairsForFiltering(bodyA, bodyB);
+}
+
+int32 b2World::CreateTrigger(const b2AABB& aabb, void* userData)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return b2BroadPhase::e_nullProxy;
+	}
+
+	int32 triggerId = m_contactManager.m_broadPhase.CreateTrigger(aabb, userData);
+
+	// Pair the trigger at the beginning of the next time step.
+	m_flags |= e_newFixture;
+
+	return triggerId;
+}
+
+void b2World::DestroyTrigger(int32 triggerId)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	b2Assert(m_contactManager.m_broadPhase.IsTrigger(triggerId));
+	m_contactManager.m_broadPhase.DestroyProxy(triggerId);
+}
+
+void b2World::MoveTrigger(int32 triggerId, const b2AABB& aabb)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	b2Assert(m_contactManager.m_broadPhase.IsTrigger(triggerId));
+	m_contactManager.m_broadPhase.MoveProxy(triggerId, aabb, b2Vec2_zero);
+}
+
+//
+void b2World::SetAllowSleeping(bool flag)
+{
+	if (flag == m_allowSleep)
+	{
+		return;
+	}
+
+	m_allowSleep = flag;
+	if (m_allowSleep == false)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		{
+			b->SetAwake(true);
+		}
+	}
+}
+
+// The blocks of moved objects are linked through their first bytes and freed
+// after the compaction pass, so that a move never reuses the block of an
+// object that was just moved.
+static void b2PushBlock(void** list, void* block)
+{
+	*(void**)block = *list;
+	*list = block;
+}
+
+static void b2FreeBlocks(b2BlockAllocator* allocator, void* list, int32 size)
+{
+	while (list)
+	{
+		void* next = *(void**)list;
+		allocator->Free(list, size);
+		list = next;
+	}
+}
+
+b2Body* b2World::RelocateBody(b2Body* b, b2GearJoint** gearJoints, int32 gearJointCount)
+{
+	void* mem = m_blockAllocator->Allocate(sizeof(b2Body));
+	memcpy(mem, b, sizeof(b2Body));
+	b2Body* nb = (b2Body*)mem;
+
+	// World list and body array.
+	if (nb->m_prev)
+	{
+		nb->m_prev->m_next = nb;
+	}
+	else
+	{
+		m_bodyList = nb;
+	}
+
+	if (nb->m_next)
+	{
+		nb->m_next->m_prev = nb;
+	}
+
+	m_bodies[nb->m_worldIndex] = nb;
+	m_bodyIds.Set(nb->m_id, nb);
+
+	if (b == m_staticGeometryBody)
+	{
+		m_staticGeometryBody = nb;
+	}
+
+	for (b2Fixture* f = nb->m_fixtureList; f; f = f->m_next)
+	{
+		f->m_body = nb;
+	}
+
+	// The edges stay in the contacts and joints, only the other side refers to this body.
+	for (b2ContactEdge* ce = nb->m_contactList; ce; ce = ce->next)
+	{
+		b2Contact* c = ce->contact;
+		b2ContactEdge* otherEdge = ce == &c->m_nodeA ? &c->m_nodeB : &c->m_nodeA;
+		otherEdge->other = nb;
+	}
+
+	for (b2JointEdge* je = nb->m_jointList; je; je = je->next)
+	{
+		b2Joint* j = je->joint;
+		if (j->m_bodyA == b)
+		{
+			j->m_bodyA = nb;
+			j->m_edgeB.other = nb;
+		}
+		else
+		{
+			j->m_bodyB = nb;
+			j->m_edgeA.other = nb;
+		}
+	}
+
+	// Gear joints also refer to the bodies of their revolute and prismatic joints.
+	for (int32 i = 0; i < gearJointCount; ++i)
+	{
+		b2GearJoint* gear = gearJoints[i];
+		if (gear->m_bodyC == b)
+		{
+			gear->m_bodyC = nb;
+		}
+
+		if (gear->m_bodyD == b)
+		{
+			gear->m_bodyD = nb;
+		}
+	}
+
+	if (nb->m_bodyPairCount > 0)
+	{
+		m_ignorePairs.RelocateBody(b, nb);
+	}
+
+	if (m_relocationListener)
+	{
+		m_relocationListener->BodyMoved(b, nb);
+	}
+
+	return nb;
+}
+
+b2Fixture* b2World::RelocateFixture(b2Fixture* f)
+{
+	void* mem = m_blockAllocator->Allocate(sizeof(b2Fixture));
+	memcpy(mem, f, sizeof(b2Fixture));
+	b2Fixture* nf = (b2Fixture*)mem;
+
+	// Find the link to this fixture in the body fixture list.
+	b2Fixture** node = &nf->m_body->m_fixtureList;
+	while (*node != f)
+	{
+		node = &(*node)->m_next;
+	}
+	*node = nf;
+
+	// The broad-phase refers to the proxies, which stay where they are.
+	for (int32 i = 0; i < nf->m_proxyCount; ++i)
+	{
+		nf->m_proxies[i].fixture = nf;
+	}
+
+	m_contactManager.RelocateFixture(f, nf);
+	m_fixtureIds.Set(nf->m_id, nf);
+
+	if (m_relocationListener)
+	{
+		m_relocationListener->FixtureMoved(f, nf);
+	}
+
+	return nf;
+}
+
+// Move the next few bodies to new memory, island by island. Islands are found
+// as in Solve, but sleeping islands and non-touching contacts are included since
+// they take part in later time steps. The budget counts bodies, so a slice can
+// stop inside an island and the next slice continues with the rest of it.
+void b2World::Compact()
+{
+	// Start a new sweep when the previous one is complete.
+	if (m_compactionCursor >= m_bodyCount && m_compactionStackCount == 0)
+	{
+		m_compactionCursor = 0;
+
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			m_bodies[i]->m_flags &= ~b2Body::e_compactFlag;
+		}
+	}
+
+	if (m_bodyCount == 0)
+	{
+		return;
+	}
+
+	// The free lists are sorted once per sweep, so the objects of an island are
+	// allocated from adjacent blocks. The blocks freed by a slice were allocated
+	// next to each other by the previous sweep and go back to the front of the
+	// free lists in the order they were moved, so later slices stay local.
+	if (m_compactionCursor == 0 && m_compactionStackCount == 0)
+	{
+		m_blockAllocator->SortFreeList(sizeof(b2Body));
+		m_blockAllocator->SortFreeList(sizeof(b2Fixture));
+	}
+
+	// Collect the gear joints once, so moving a body does not walk the joint list.
+	int32 gearJointCount = 0;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type == e_gearJoint)
+		{
+			++gearJointCount;
+		}
+	}
+
+	b2GearJoint** gearJoints = nullptr;
+	if (gearJointCount > 0)
+	{
+		gearJoints = (b2GearJoint**)m_stackAllocator->Allocate(gearJointCount * sizeof(b2GearJoint*));
+
+		int32 i = 0;
+		for (b2Joint* j = m_jointList; j; j = j->m_next)
+		{
+			if (j->m_type == e_gearJoint)
+			{
+				gearJoints[i++] = (b2GearJoint*)j;
+			}
+		}
+	}
+
+	void* oldBodies = nullptr;
+	void* oldFixtures = nullptr;
+
+	// Each body is pushed at most once per sweep.
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator->Allocate(stackSize * sizeof(b2Body*));
+
+	// Resume the island of the last slice. Destroyed bodies are skipped.
+	int32 stackCount = 0;
+	for (int32 i = 0; i < m_compactionStackCount; ++i)
+	{
+		b2Body* b = GetBody(m_compactionStack[i]);
+		if (b)
+		{
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = b;
+		}
+	}
+	m_compactionStackCount = 0;
+
+	int32 moveCount = 0;
+	while (moveCount < m_compactionBudget)
+	{
+		if (stackCount == 0)
+		{
+			if (m_compactionCursor >= m_bodyCount)
+			{
+				break;
+			}
+
+			b2Body* seed = m_bodies[m_compactionCursor];
+			++m_compactionCursor;
+
+			if (seed->m_flags & b2Body::e_compactFlag)
+			{
+				continue;
+			}
+
+			stack[stackCount++] = seed;
+			seed->m_flags |= b2Body::e_compactFlag;
+		}
+
+		b2Body* oldBody = stack[--stackCount];
+		b2Body* b = RelocateBody(oldBody, gearJoints, gearJointCount);
+		b2PushBlock(&oldBodies, oldBody);
+		++moveCount;
+
+		b2Fixture* f = b->m_fixtureList;
+		while (f)
+		{
+			b2Fixture* nf = RelocateFixture(f);
+			b2PushBlock(&oldFixtures, f);
+			f = nf->m_next;
+		}
+
+		// Static bodies are shared by many islands, so they don't connect them.
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// The contacts stay in the contact arrays of their shape types.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Body* other = ce->other;
+			if (other->m_flags & b2Body::e_compactFlag)
+			{
+				continue;
+			}
+
+			// Only touching contacts connect the island.
+			if (ce->contact->IsEnabled() == false ||
+				ce->contact->IsTouching() == false)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_compactFlag;
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			b2Body* other = je->other;
+			if (other->m_flags & b2Body::e_compactFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_compactFlag;
+		}
+	}
+
+	// Keep the rest of the island for the next slice.
+	if (stackCount > 0)
+	{
+		ReserveCompactionStack(m_bodyCapacity);
+	}
+
+	for (int32 i = 0; i < stackCount; ++i)
+	{
+		m_compactionStack[i] = stack[i]->m_id;
+	}
+	m_compactionStackCount = stackCount;
+
+	m_stackAllocator->Free(stack);
+
+	if (gearJoints)
+	{
+		m_stackAllocator->Free(gearJoints);
+	}
+
+	b2FreeBlocks(m_blockAllocator, oldBodies, sizeof(b2Body));
+	b2FreeBlocks(m_blockAllocator, oldFixtures, sizeof(b2Fixture));
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
@@ -393,26 +1294,33 @@ void b2World::Solve(const b2TimeStep& step)
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
 					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+					m_stackAllocator,
+					&m_contactManager);
 
 	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	b2Body** bodies = m_bodies;
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		bodies[i]->m_flags &= ~b2Body::e_islandFlag;
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	for (int32 i = 0; i < b2ContactManager::e_arrayCount; ++i)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		const b2ContactArray* array = m_contactManager.m_contactArrays + i;
+		for (int32 j = 0; j < array->count; ++j)
+		{
+			array->GetContact(j)->m_flags &= ~b2Contact::e_islandFlag;
+		}
 	}
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
 	{
 		j->m_islandFlag = false;
 	}
 
-	// Build and simulate all awake islands.
+	// Build and simulate all awake islands. The seeds are taken in body list order,
+	// not array order, because the island order and the body order within an island
+	// change the results. Removal from the array reorders it.
 	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)m_stackAllocator->Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
 		if (seed->m_flags & b2Body::e_islandFlag)
@@ -473,14 +1381,6 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
-
 				island.Add(contact);
 				contact->m_flags |= b2Contact::e_islandFlag;
 
@@ -533,6 +1433,12 @@ void b2World::Solve(const b2TimeStep& step)
 		m_profile.solveVelocity += profile.solveVelocity;
 		m_profile.solvePosition += profile.solvePosition;
 
+		// Report the broken joints. They are destroyed after the time step.
+		for (int32 i = 0; i < island.m_brokenJointCount; ++i)
+		{
+			PushJointBreakEvent(island.m_brokenJoints[i], step.inv_dt);
+		}
+
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
 		{
@@ -545,13 +1451,15 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
-	m_stackAllocator.Free(stack);
+	m_stackAllocator->Free(stack);
 
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
+			b2Body* b = bodies[i];
+
 			// If a body was not in an island then it did not move.
 			if ((b->m_flags & b2Body::e_islandFlag) == 0)
 			{
@@ -573,25 +1481,84 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+void b2World::PushJointBreakEvent(b2Joint* joint, float32 inv_dt)
+{
+	if (m_jointBreakEventCount == m_jointBreakEventCapacity)
+	{
+		b2JointBreakEvent* oldEvents = m_jointBreakEvents;
+		m_jointBreakEventCapacity = m_jointBreakEventCapacity > 0 ? 2 * m_jointBreakEventCapacity : 16;
+		m_jointBreakEvents = (b2JointBreakEvent*)m_allocator.Allocate(m_jointBreakEventCapacity * sizeof(b2JointBreakEvent));
+		if (oldEvents)
+		{
+			memcpy(m_jointBreakEvents, oldEvents, m_jointBreakEventCount * sizeof(b2JointBreakEvent));
+			m_allocator.Free(oldEvents);
+		}
+	}
+
+	b2JointBreakEvent* event = m_jointBreakEvents + m_jointBreakEventCount;
+	event->joint = joint;
+	event->userData = joint->m_userData;
+	event->bodyA = joint->m_bodyA;
+	event->bodyB = joint->m_bodyB;
+	event->reactionForce = joint->GetReactionForce(inv_dt);
+	event->reactionTorque = joint->GetReactionTorque(inv_dt);
+	++m_jointBreakEventCount;
+}
+
+// A gear joint keeps pointers to its revolute or prismatic joints, so it
+// breaks with them instead of being left with a dangling joint.
+void b2World::BreakGearJoints(float32 inv_dt)
+{
+	int32 brokenCount = m_jointBreakEventCount;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->m_type != e_gearJoint)
+		{
+			continue;
+		}
+
+		b2GearJoint* gear = (b2GearJoint*)j;
+		bool broken = false;
+		bool reported = false;
+		for (int32 i = 0; i < brokenCount; ++i)
+		{
+			b2Joint* joint = m_jointBreakEvents[i].joint;
+			broken = broken || joint == gear->m_joint1 || joint == gear->m_joint2;
+			reported = reported || joint == gear;
+		}
+
+		if (broken && reported == false)
+		{
+			PushJointBreakEvent(gear, inv_dt);
+		}
+	}
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, m_stackAllocator, &m_contactManager);
 
 	if (m_stepComplete)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			m_bodies[i]->m_flags &= ~b2Body::e_islandFlag;
+			m_bodyArrays.sweeps[i].alpha0 = 0.0f;
 		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		for (int32 i = 0; i < b2ContactManager::e_arrayCount; ++i)
 		{
-			// Invalidate TOI
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
-			c->m_toiCount = 0;
-			c->m_toi = 1.0f;
+			const b2ContactArray* array = m_contactManager.m_contactArrays + i;
+			for (int32 j = 0; j < array->count; ++j)
+			{
+				b2Contact* c = array->GetContact(j);
+
+				// Invalidate TOI
+				c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+				c->m_toiCount = 0;
+				c->m_toi = 1.0f;
+			}
 		}
 	}
 
@@ -602,112 +1569,112 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		b2Contact* minContact = nullptr;
 		float32 minAlpha = 1.0f;
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		for (int32 i = 0; i < b2ContactManager::e_arrayCount; ++i)
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
-
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > b2_maxSubSteps)
-			{
-				continue;
-			}
-
-			float32 alpha = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
+			const b2ContactArray* array = m_contactManager.m_contactArrays + i;
+			for (int32 j = 0; j < array->count; ++j)
 			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
-			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+				b2Contact* c = array->GetContact(j);
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
+				// Is this contact disabled?
+				if (c->IsEnabled() == false)
 				{
 					continue;
 				}
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
-
-				b2BodyType typeA = bA->m_type;
-				b2BodyType typeB = bB->m_type;
-
-				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
-
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
+				// Prevent excessive sub-stepping.
+				if (c->m_toiCount > b2_maxSubSteps)
 				{
 					continue;
 				}
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
-
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
+				float32 alpha = 1.0f;
+				if (c->m_flags & b2Contact::e_toiFlag)
 				{
-					continue;
+					// This contact has a valid cached TOI.
+					alpha = c->m_toi;
 				}
+				else
+				{
+					b2Fixture* fA = c->GetFixtureA();
+					b2Fixture* fB = c->GetFixtureB();
+
+					b2Body* bA = fA->GetBody();
+					b2Body* bB = fB->GetBody();
+
+					b2BodyType typeA = bA->m_type;
+					b2BodyType typeB = bB->m_type;
+
+					bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+					bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+
+					// Is at least one body active (awake and dynamic or kinematic)?
+					if (activeA == false && activeB == false)
+					{
+						continue;
+					}
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float32 alpha0 = bA->m_sweep.alpha0;
+					bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+					bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+
+					// Are these two non-bullet dynamic bodies?
+					if (collideA == false && collideB == false)
+					{
+						continue;
+					}
+
+					// Compute the TOI for this contact.
+					// Put the sweeps onto the same time interval.
+					float32 alpha0 = bA->Sweep().alpha0;
+
+					if (bA->Sweep().alpha0 < bB->Sweep().alpha0)
+					{
+						alpha0 = bB->Sweep().alpha0;
+						bA->Sweep().Advance(alpha0);
+					}
+					else if (bB->Sweep().alpha0 < bA->Sweep().alpha0)
+					{
+						alpha0 = bA->Sweep().alpha0;
+						bB->Sweep().Advance(alpha0);
+					}
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
+					b2Assert(alpha0 < 1.0f);
 
-				b2Assert(alpha0 < 1.0f);
+					int32 indexA = c->GetChildIndexA();
+					int32 indexB = c->GetChildIndexB();
 
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
+					// Compute the time of impact in interval [0, minTOI]
+					b2TOIInput input;
+					input.proxyA.Set(fA->GetShape(), indexA);
+					input.proxyB.Set(fB->GetShape(), indexB);
+					input.sweepA = bA->Sweep();
+					input.sweepB = bB->Sweep();
+					input.tMax = 1.0f;
 
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+					b2TOIOutput output;
+					b2TimeOfImpact(&output, &input);
 
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+					// Beta is the fraction of the remaining portion of the .
+					float32 beta = output.t;
+					if (output.state == b2TOIOutput::e_touching)
+					{
+						alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+					}
+					else
+					{
+						alpha = 1.0f;
+					}
 
-				// Beta is the fraction of the remaining portion of the .
-				float32 beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+					c->m_toi = alpha;
+					c->m_flags |= b2Contact::e_toiFlag;
 				}
-				else
+
+				if (alpha < minAlpha)
 				{
-					alpha = 1.0f;
+					// This is the minimum TOI found so far.
+					minContact = c;
+					minAlpha = alpha;
 				}
-
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
-			}
-
-			if (alpha < minAlpha)
-			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
 			}
 		}
 
@@ -724,14 +1691,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		b2Body* bA = fA->GetBody();
 		b2Body* bB = fB->GetBody();
 
-		b2Sweep backup1 = bA->m_sweep;
-		b2Sweep backup2 = bB->m_sweep;
+		b2Sweep backup1 = bA->Sweep();
+		b2Sweep backup2 = bB->Sweep();
 
 		bA->Advance(minAlpha);
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(&m_contactManager);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -740,8 +1707,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		{
 			// Restore the sweeps.
 			minContact->SetEnabled(false);
-			bA->m_sweep = backup1;
-			bB->m_sweep = backup2;
+			bA->Sweep() = backup1;
+			bB->Sweep() = backup2;
 			bA->SynchronizeTransform();
 			bB->SynchronizeTransform();
 			continue;
@@ -795,28 +1762,20 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
-					// Skip sensors.
-					bool sensorA = contact->m_fixtureA->m_isSensor;
-					bool sensorB = contact->m_fixtureB->m_isSensor;
-					if (sensorA || sensorB)
-					{
-						continue;
-					}
-
 					// Tentatively advance the body to the TOI.
-					b2Sweep backup = other->m_sweep;
+					b2Sweep backup = other->Sweep();
 					if ((other->m_flags & b2Body::e_islandFlag) == 0)
 					{
 						other->Advance(minAlpha);
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(&m_contactManager);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
 					{
-						other->m_sweep = backup;
+						other->Sweep() = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -824,7 +1783,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					// Are there contact points?
 					if (contact->IsTouching() == false)
 					{
-						other->m_sweep = backup;
+						other->Sweep() = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -896,6 +1855,25 @@ void b2World::SolveTOI(const b2TimeStep& step)
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
 	b2Timer stepTimer;
+	int32 allocationCount = b2GetAllocationCount();
+
+	// The collision statistics are per thread. Sample them around this step
+	// and restore the running maximums afterwards.
+	int32 gjkCalls = b2_gjkCalls, gjkIters = b2_gjkIters, gjkMaxIters = b2_gjkMaxIters;
+	int32 toiCalls = b2_toiCalls, toiIters = b2_toiIters, toiMaxIters = b2_toiMaxIters;
+	int32 toiRootIters = b2_toiRootIters, toiMaxRootIters = b2_toiMaxRootIters;
+	b2_gjkMaxIters = 0;
+	b2_toiMaxIters = 0;
+	b2_toiMaxRootIters = 0;
+
+	// Trigger and contact events are accumulated over the time step.
+	m_contactManager.m_broadPhase.ClearTriggerEvents();
+	m_contactManager.ClearEvents();
+	m_jointBreakEventCount = 0;
+
+	// Fill the slots of the contacts destroyed since the last time step. Contacts
+	// only move during a time step.
+	m_contactManager.ReleaseContacts();
 
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
@@ -906,6 +1884,20 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags |= e_locked;
 
+	// Move a slice of the world for memory locality.
+	if (m_compactionBudget > 0)
+	{
+		Compact();
+	}
+
+	// The carried end events may refer to fixtures that were destroyed or moved.
+	for (int32 i = 0; i < m_contactManager.m_endEventCount; ++i)
+	{
+		b2ContactEndTouchEvent* event = m_contactManager.m_endEvents + i;
+		event->fixtureA = (b2Fixture*)m_fixtureIds.Get(event->fixtureIdA);
+		event->fixtureB = (b2Fixture*)m_fixtureIds.Get(event->fixtureIdB);
+	}
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
@@ -946,6 +1938,13 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
+	// Update sensor overlaps after all the bodies have moved.
+	{
+		b2Timer timer;
+		m_contactManager.m_sensorManager.Update(&m_contactManager.m_broadPhase);
+		m_profile.sensors = timer.GetMilliseconds();
+	}
+
 	if (step.dt > 0.0f)
 	{
 		m_inv_dt0 = step.inv_dt;
@@ -957,16 +1956,409 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	}
 
 	m_flags &= ~e_locked;
+	m_contactManager.m_stepEndEventCount = m_contactManager.m_endEventCount;
+
+	// Remove the joints that broke during this time step.
+	if (m_jointBreakEventCount > 0)
+	{
+		BreakGearJoints(step.inv_dt);
+	}
+
+	for (int32 i = 0; i < m_jointBreakEventCount; ++i)
+	{
+		DestroyJoint(m_jointBreakEvents[i].joint);
+	}
+
+	if (m_flags & e_querySnapshots)
+	{
+		PublishQuerySnapshot();
+	}
 
 	m_profile.step = stepTimer.GetMilliseconds();
+	m_profile.stackAllocation = m_stackAllocator->GetMaxAllocation();
+	m_profile.allocations = b2GetAllocationCount() - allocationCount;
+
+	m_profile.gjkCalls = b2_gjkCalls - gjkCalls;
+	m_profile.gjkIters = b2_gjkIters - gjkIters;
+	m_profile.gjkMaxIters = b2_gjkMaxIters;
+	m_profile.toiCalls = b2_toiCalls - toiCalls;
+	m_profile.toiIters = b2_toiIters - toiIters;
+	m_profile.toiMaxIters = b2_toiMaxIters;
+	m_profile.toiRootIters = b2_toiRootIters - toiRootIters;
+	m_profile.toiMaxRootIters = b2_toiMaxRootIters;
+	b2_gjkMaxIters = b2Max(b2_gjkMaxIters, gjkMaxIters);
+	b2_toiMaxIters = b2Max(b2_toiMaxIters, toiMaxIters);
+	b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, toiMaxRootIters);
+
+	// A steady state time step should not touch the heap.
+	b2Assert((m_flags & e_checkAllocations) == 0 || m_profile.allocations == 0);
+}
+
+void b2World::SetQuerySnapshots(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_querySnapshots;
+		return;
+	}
+
+	m_flags &= ~e_querySnapshots;
+
+	// Snapshots that are still referenced elsewhere stay alive.
+	if (m_querySnapshot)
+	{
+		m_querySnapshot->Release();
+		m_querySnapshot = nullptr;
+	}
+
+	if (m_spareSnapshot)
+	{
+		m_spareSnapshot->Release();
+		m_spareSnapshot = nullptr;
+	}
+}
+
+void b2World::PublishQuerySnapshot()
+{
+	// Rebuild the previous snapshot if no other thread uses it.
+	b2QuerySnapshot* snapshot = m_spareSnapshot;
+	if (snapshot && snapshot->m_refCount.IsUnique() == false)
+	{
+		snapshot->Release();
+		snapshot = nullptr;
+	}
+
+	if (snapshot == nullptr)
+	{
+		snapshot = b2QuerySnapshot::Create(m_allocator);
+	}
+
+	const b2DynamicTree& tree = m_contactManager.m_broadPhase.GetTree();
+	snapshot->m_tree.CopyFrom(&tree);
+
+	int32 capacity = tree.GetNodeCapacity();
+	if (snapshot->m_proxyCapacity < capacity)
+	{
+		m_allocator.Free(snapshot->m_proxies);
+		m_allocator.Free(snapshot->m_shapes);
+		snapshot->m_proxies = (b2QueryProxy*)m_allocator.Allocate(capacity * sizeof(b2QueryProxy));
+		snapshot->m_shapes = (b2SnapshotShape*)m_allocator.Allocate(capacity * sizeof(b2SnapshotShape));
+		snapshot->m_proxyCapacity = capacity;
+	}
+
+	// Unused entries and triggers have a null fixture id.
+	for (int32 i = 0; i < snapshot->m_proxyCapacity; ++i)
+	{
+		snapshot->m_proxies[i].fixtureId = b2_nullId;
+	}
+
+	// The static geometry cannot move, so its entries are only written when it is attached.
+	// The geometry holds the shapes of these entries and the snapshot holds the geometry.
+	b2BodyId staticBodyId = m_staticGeometryBody ? m_staticGeometryBody->m_id : b2_nullId;
+	bool writeStatic = snapshot->m_staticGeometry != m_staticGeometry || snapshot->m_staticBodyId != staticBodyId;
+	if (writeStatic)
+	{
+		if (m_staticGeometry)
+		{
+			m_staticGeometry->Retain();
+		}
+
+		if (snapshot->m_staticGeometry)
+		{
+			snapshot->m_staticGeometry->Release();
+		}
+
+		snapshot->m_staticGeometry = m_staticGeometry;
+		snapshot->m_staticBodyId = staticBodyId;
+
+		if (m_staticGeometry)
+		{
+			int32 staticCapacity = m_staticGeometry->GetTree().GetNodeCapacity();
+			if (snapshot->m_staticProxyCapacity < staticCapacity)
+			{
+				m_allocator.Free(snapshot->m_staticProxies);
+				snapshot->m_staticProxies = (b2QueryProxy*)m_allocator.Allocate(staticCapacity * sizeof(b2QueryProxy));
+				snapshot->m_staticProxyCapacity = staticCapacity;
+			}
+
+			for (int32 i = 0; i < snapshot->m_staticProxyCapacity; ++i)
+			{
+				snapshot->m_staticProxies[i].fixtureId = b2_nullId;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b == m_staticGeometryBody && writeStatic == false)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				int32 proxyId = f->m_proxies[j].proxyId;
+				int32 childIndex = f->m_proxies[j].childIndex;
+				b2QueryProxy* proxy;
+				if (b2BroadPhase::IsStaticProxy(proxyId))
+				{
+					proxy = snapshot->m_staticProxies + (proxyId - b2BroadPhase::e_staticProxy);
+					proxy->shape = f->m_shape;
+				}
+				else
+				{
+					proxy = snapshot->m_proxies + proxyId;
+					proxy->shape = snapshot->CopyShape(proxyId, f->m_shape, childIndex);
+				}
+
+				proxy->fixtureId = f->m_id;
+				proxy->bodyId = b->m_id;
+				proxy->childIndex = childIndex;
+				proxy->transform = b->Transform();
+				proxy->filter = f->m_filter;
+				proxy->userData = f->m_userData;
+				proxy->isSensor = f->m_isSensor;
+			}
+		}
+	}
+
+	snapshot->m_version = m_snapshotVersion;
+	++m_snapshotVersion;
+
+	m_spareSnapshot = m_querySnapshot;
+	m_querySnapshot = snapshot;
+}
+
+void b2World::StepAsync(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	b2Assert(m_stepping == false);
+	b2Assert(IsLocked() == false);
+	if (m_stepping || IsLocked())
+	{
+		return;
+	}
+
+	if (m_worker == nullptr)
+	{
+		void* mem = m_allocator.Allocate(sizeof(b2StepWorker));
+		m_worker = new (mem) b2StepWorker(this);
+
+		// Publish the initial state so it can be read during the first step.
+		WriteBodyStates(m_stateIndex);
+	}
+
+	m_stepping = true;
+	m_worker->Start(timeStep, velocityIterations, positionIterations);
+}
+
+static void b2StoreBodyState(b2BodyState* state, const b2Body* body)
+{
+	state->id = body->GetId();
+	state->transform = body->GetTransform();
+	state->linearVelocity = body->GetLinearVelocity();
+	state->angularVelocity = body->GetAngularVelocity();
+}
+
+void b2World::WriteBodyStates(int32 buffer)
+{
+	int32 capacity = m_bodyIds.GetCapacity();
+	if (m_bodyStateCapacity[buffer] < capacity)
+	{
+		m_allocator.Free(m_bodyStates[buffer]);
+		m_bodyStates[buffer] = (b2BodyState*)m_allocator.Allocate(capacity * sizeof(b2BodyState));
+		m_bodyStateCapacity[buffer] = capacity;
+	}
+
+	// Slots without a body keep a null id.
+	b2BodyState* states = m_bodyStates[buffer];
+	for (int32 i = 0; i < m_bodyStateCapacity[buffer]; ++i)
+	{
+		states[i].id = b2_nullId;
+	}
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		const b2Body* b = m_bodies[i];
+		if (b->m_id == b2_nullId)
+		{
+			// The handle table was full.
+			continue;
+		}
+
+		int32 index = int32(b->m_id >> b2HandleTable::e_generationBits);
+		b2StoreBodyState(states + index, b);
+	}
+}
+
+void b2World::Sync()
+{
+	if (m_stepping)
+	{
+		m_worker->Wait();
+		m_stepping = false;
+		m_stateIndex ^= 1;
+	}
+
+	b2BodyState* states = m_bodyStates[m_stateIndex];
+	int32 stateCapacity = m_bodyStateCapacity[m_stateIndex];
+	bool rewrite = false;
+
+	// A function may queue more commands, so the count is read each iteration.
+	for (int32 i = 0; i < m_commandCount; ++i)
+	{
+		b2WorldCommand command = m_commands[i];
+
+		if (command.type == b2WorldCommand::e_function)
+		{
+			command.fcn(this, command.context);
+			rewrite = true;
+			continue;
+		}
+
+		b2Body* b = GetBody(command.bodyId);
+		if (b == nullptr)
+		{
+			continue;
+		}
+
+		switch (command.type)
+		{
+		case b2WorldCommand::e_applyForce:
+			b->ApplyForce(command.vector, command.point, true);
+			break;
+
+		case b2WorldCommand::e_applyLinearImpulse:
+			b->ApplyLinearImpulse(command.vector, command.point, true);
+			break;
+
+		case b2WorldCommand::e_applyTorque:
+			b->ApplyTorque(command.scalar, true);
+			break;
+
+		case b2WorldCommand::e_setTransform:
+			b->SetTransform(command.vector, command.scalar);
+			break;
+
+		case b2WorldCommand::e_setVelocity:
+			b->SetLinearVelocity(command.vector);
+			b->SetAngularVelocity(command.scalar);
+			break;
+
+		case b2WorldCommand::e_destroyBody:
+			DestroyBody(b);
+			b = nullptr;
+			break;
+
+		default:
+			b2Assert(false);
+			break;
+		}
+
+		// Keep the published state of this body current.
+		int32 index = int32(command.bodyId >> b2HandleTable::e_generationBits);
+		if (rewrite == false && index < stateCapacity)
+		{
+			if (b)
+			{
+				b2StoreBodyState(states + index, b);
+			}
+			else
+			{
+				states[index].id = b2_nullId;
+			}
+		}
+	}
+
+	m_commandCount = 0;
+
+	if (rewrite)
+	{
+		WriteBodyStates(m_stateIndex);
+	}
+}
+
+b2WorldCommand* b2World::PushCommand(int32 type, b2BodyId id)
+{
+	if (m_commandCount == m_commandCapacity)
+	{
+		b2WorldCommand* oldCommands = m_commands;
+		m_commandCapacity = m_commandCapacity > 0 ? 2 * m_commandCapacity : 16;
+		m_commands = (b2WorldCommand*)m_allocator.Allocate(m_commandCapacity * sizeof(b2WorldCommand));
+		if (oldCommands)
+		{
+			memcpy(m_commands, oldCommands, m_commandCount * sizeof(b2WorldCommand));
+			m_allocator.Free(oldCommands);
+		}
+	}
+
+	b2WorldCommand* command = m_commands + m_commandCount;
+	++m_commandCount;
+
+	command->type = b2WorldCommand::Type(type);
+	command->bodyId = id;
+	command->vector.SetZero();
+	command->point.SetZero();
+	command->scalar = 0.0f;
+	command->fcn = nullptr;
+	command->context = nullptr;
+	return command;
+}
+
+void b2World::QueueForce(b2BodyId id, const b2Vec2& force, const b2Vec2& point)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_applyForce, id);
+	command->vector = force;
+	command->point = point;
+}
+
+void b2World::QueueLinearImpulse(b2BodyId id, const b2Vec2& impulse, const b2Vec2& point)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_applyLinearImpulse, id);
+	command->vector = impulse;
+	command->point = point;
+}
+
+void b2World::QueueTorque(b2BodyId id, float32 torque)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_applyTorque, id);
+	command->scalar = torque;
+}
+
+void b2World::QueueTransform(b2BodyId id, const b2Vec2& position, float32 angle)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_setTransform, id);
+	command->vector = position;
+	command->scalar = angle;
+}
+
+void b2World::QueueVelocity(b2BodyId id, const b2Vec2& linearVelocity, float32 angularVelocity)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_setVelocity, id);
+	command->vector = linearVelocity;
+	command->scalar = angularVelocity;
+}
+
+void b2World::QueueDestroyBody(b2BodyId id)
+{
+	PushCommand(b2WorldCommand::e_destroyBody, id);
+}
+
+void b2World::QueueCommand(b2WorldCommandFcn* fcn, void* context)
+{
+	b2WorldCommand* command = PushCommand(b2WorldCommand::e_function, b2_nullId);
+	command->fcn = fcn;
+	command->context = context;
 }
 
 void b2World::ClearForces()
 {
-	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		body->m_force.SetZero();
-		body->m_torque = 0.0f;
+		m_bodyArrays.forces[i].SetZero();
+		m_bodyArrays.torques[i] = 0.0f;
 	}
 }
 
@@ -974,6 +2366,11 @@ struct b2WorldQueryWrapper
 {
 	bool QueryCallback(int32 proxyId)
 	{
+		if (broadPhase->IsTrigger(proxyId))
+		{
+			return true;
+		}
+
 		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
 		return callback->ReportFixture(proxy->fixture);
 	}
@@ -994,6 +2391,11 @@ struct b2WorldRayCastWrapper
 {
 	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
 	{
+		if (broadPhase->IsTrigger(proxyId))
+		{
+			return input.maxFraction;
+		}
+
 		void* userData = broadPhase->GetUserData(proxyId);
 		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
 		b2Fixture* fixture = proxy->fixture;
@@ -1281,11 +2683,11 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 		return;
 	}
 
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b->m_xf.p -= newOrigin;
-		b->m_sweep.c0 -= newOrigin;
-		b->m_sweep.c -= newOrigin;
+		m_bodyArrays.transforms[i].p -= newOrigin;
+		m_bodyArrays.sweeps[i].c0 -= newOrigin;
+		m_bodyArrays.sweeps[i].c -= newOrigin;
 	}
 
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
@@ -1296,6 +2698,102 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
 }
 
+// The allocation size of a shape and its vertices.
+static int32 b2GetShapeByteCount(const b2Shape* shape)
+{
+	switch (shape->GetType())
+	{
+	case b2Shape::e_circle:
+		return b2BlockAllocator::GetBlockSize(sizeof(b2CircleShape));
+
+	case b2Shape::e_edge:
+		return b2BlockAllocator::GetBlockSize(sizeof(b2EdgeShape));
+
+	case b2Shape::e_polygon:
+		return b2BlockAllocator::GetBlockSize(sizeof(b2PolygonShape));
+
+	case b2Shape::e_chain:
+		{
+			const b2ChainShape* chain = (const b2ChainShape*)shape;
+			return b2BlockAllocator::GetBlockSize(sizeof(b2ChainShape)) + chain->m_count * sizeof(b2Vec2);
+		}
+
+	default:
+		b2Assert(false);
+		return 0;
+	}
+}
+
+void b2World::GetMemoryStats(b2MemoryStats* stats) const
+{
+	memset(stats, 0, sizeof(b2MemoryStats));
+
+	int32 bodySize = b2BlockAllocator::GetBlockSize(sizeof(b2Body));
+	int32 fixtureSize = b2BlockAllocator::GetBlockSize(sizeof(b2Fixture));
+	int32 sensorSize = b2BlockAllocator::GetBlockSize(sizeof(b2Sensor));
+
+	stats->bodyBytes = m_bodyCount * bodySize + m_bodyCapacity * (sizeof(b2Body*) + b2_bodyStateSize) + m_bodyIds.GetByteCount();
+	stats->bodyBytes += (m_bodyStateCapacity[0] + m_bodyStateCapacity[1]) * sizeof(b2BodyState);
+	stats->bodyBytes += m_compactionStackCapacity * sizeof(b2BodyId);
+	stats->fixtureBytes = m_fixtureIds.GetByteCount();
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		for (const b2Fixture* f = m_bodies[i]->m_fixtureList; f; f = f->m_next)
+		{
+			int32 childCount = f->m_shape->GetChildCount();
+			stats->fixtureBytes += fixtureSize + b2BlockAllocator::GetBlockSize(childCount * sizeof(b2FixtureProxy));
+			if (f->m_sensor)
+			{
+				stats->fixtureBytes += sensorSize + f->m_sensor->overlapCapacity * sizeof(b2SensorOverlap);
+			}
+
+			// Shared shapes are not part of this world.
+			if (f->m_shared == false && f->m_sharedShape == nullptr)
+			{
+				stats->shapeBytes += b2GetShapeByteCount(f->m_shape);
+			}
+		}
+	}
+
+	const b2ContactManager& cm = m_contactManager;
+	stats->contactBytes = cm.m_freeSlotCapacity * sizeof(b2ContactSlot);
+	for (int32 i = 0; i < b2ContactManager::e_arrayCount; ++i)
+	{
+		stats->contactBytes += cm.m_contactArrays[i].capacity * sizeof(b2Contact);
+	}
+	stats->contactBytes += cm.m_pairCapacity * sizeof(b2ContactPair);
+	stats->contactBytes += cm.m_beginEventCapacity * sizeof(b2ContactBeginTouchEvent);
+	stats->contactBytes += cm.m_endEventCapacity * sizeof(b2ContactEndTouchEvent);
+	stats->contactBytes += cm.m_hitEventCapacity * sizeof(b2ContactHitEvent);
+	stats->contactBytes += cm.m_impulseEventCapacity * sizeof(b2ContactImpulseEvent);
+	stats->contactBytes += cm.m_contactIds.GetByteCount();
+
+	stats->jointBytes = m_jointBreakEventCapacity * sizeof(b2JointBreakEvent) + m_jointIds.GetByteCount();
+	for (const b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		stats->jointBytes += b2BlockAllocator::GetBlockSize(b2Joint::GetSize(j->m_type));
+	}
+
+	stats->treeBytes = cm.m_broadPhase.GetTreeByteCount();
+	stats->broadPhaseBytes = cm.m_broadPhase.GetBufferByteCount();
+	if (m_staticGeometry)
+	{
+		stats->broadPhaseBytes += m_staticGeometry->m_tree.GetNodeCapacity() * sizeof(void*);
+	}
+
+	stats->stackBytes = m_stackAllocator->GetCapacity();
+	stats->stackMaxBytes = m_stackAllocator->GetMaxAllocation();
+
+	stats->chunkCount = m_blockAllocator->GetChunkCount();
+	stats->chunkSlackBytes = m_blockAllocator->GetSlackByteCount();
+	stats->chunkBytes = stats->chunkCount * m_blockAllocator->GetChunkSize() - stats->chunkSlackBytes;
+	stats->chunkFreeBytes = m_blockAllocator->GetFreeByteCount();
+
+	stats->sharedBlocks = m_blockAllocator != &m_ownBlockAllocator;
+	stats->sharedStack = m_stackAllocator != &m_ownStackAllocator;
+}
+
 void b2World::Dump()
 {
 	if ((m_flags & e_locked) == e_locked)
@@ -22,6 +22,9 @@
 #include "Box2D/Common/b2Math.h"
 #include "Box2D/Common/b2BlockAllocator.h"
 #include "Box2D/Common/b2StackAllocator.h"
+#include "Box2D/Common/b2HandleTable.h"
+#include "Box2D/Dynamics/b2Body.h"
+#include "Box2D/Dynamics/b2BodyPairSet.h"
 #include "Box2D/Dynamics/b2ContactManager.h"
 #include "Box2D/Dynamics/b2WorldCallbacks.h"
 #include "Box2D/Dynamics/b2TimeStep.h"
@@ -30,10 +33,117 @@ struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
 struct b2JointDef;
-class b2Body;
+struct b2JointBreakEvent;
 class b2Draw;
 class b2Fixture;
+class b2GearJoint;
 class b2Joint;
+class b2QuerySnapshot;
+class b2StaticGeometry;
+class b2StepWorker;
+struct b2WorldCommand;
+
+/// Memory used by a world in bytes, see b2World::GetMemoryStats. Objects in the
+/// block allocator count with their block size. The free chunk bytes are held
+/// by the block allocator without being used, which measures fragmentation.
+/// The object figures are per world. The chunk figures describe the whole block
+/// allocator and the stack figures the whole stack allocator, so they include
+/// other worlds when the allocators are shared, see sharedBlocks and sharedStack.
+struct b2MemoryStats
+{
+	int32 bodyBytes;		///< bodies, the body array, handles and published body states
+	int32 fixtureBytes;		///< fixtures, their proxies and handles
+	int32 shapeBytes;		///< shapes and chain vertices
+	int32 contactBytes;		///< contacts, pairs, the contact arrays and handles
+	int32 jointBytes;		///< joints and handles
+	int32 treeBytes;		///< the dynamic tree node pool
+	int32 broadPhaseBytes;	///< the broad-phase move, pair and trigger buffers
+	int32 stackBytes;		///< the stack allocator capacity
+	int32 stackMaxBytes;	///< the largest stack allocator usage so far
+	int32 chunkCount;		///< the number of block allocator chunks
+	int32 chunkBytes;		///< the block space of all chunks
+	int32 chunkFreeBytes;	///< free blocks in the chunks
+	int32 chunkSlackBytes;	///< chunk space too small for a block
+	bool sharedBlocks;		///< the block allocator comes from b2WorldDef::blockAllocator
+	bool sharedStack;		///< the stack allocator comes from b2WorldDef::stackAllocator
+};
+
+/// The state of a body at the end of a time step, see b2World::GetBodyState.
+struct b2BodyState
+{
+	b2BodyId id;				///< the body handle
+	b2Transform transform;		///< the body origin transform
+	b2Vec2 linearVelocity;		///< the linear velocity of the center of mass
+	float32 angularVelocity;	///< the angular velocity
+};
+
+/// A world definition holds the data needed to construct a world. The capacities
+/// are the expected object counts. Memory for them is reserved up front, so the
+/// containers of the world do not have to grow during the simulation. Exceeding a
+/// capacity is allowed, the world then grows as usual.
+struct b2WorldDef
+{
+	/// This constructor sets the world definition default values.
+	b2WorldDef()
+	{
+		gravity.Set(0.0f, -10.0f);
+		bodyCapacity = 0;
+		fixtureCapacity = 0;
+		proxyCapacity = 0;
+		contactCapacity = 0;
+		jointCapacity = 0;
+		stackSize = 0;
+		chunkSize = b2_chunkSize;
+		allocator = nullptr;
+		blockAllocator = nullptr;
+		stackAllocator = nullptr;
+	}
+
+	/// The world gravity vector.
+	b2Vec2 gravity;
+
+	/// The expected number of bodies.
+	int32 bodyCapacity;
+
+	/// The expected number of fixtures.
+	int32 fixtureCapacity;
+
+	/// The expected number of broad-phase proxies. Chain shapes have a proxy per edge,
+	/// other shapes have one. Zero uses the fixture capacity.
+	int32 proxyCapacity;
+
+	/// The expected number of contacts.
+	int32 contactCapacity;
+
+	/// The expected number of joints.
+	int32 jointCapacity;
+
+	/// The bytes to reserve in the per step stack allocator. Zero reserves nothing and the
+	/// stack allocates a block of b2_stackSize on first use.
+	int32 stackSize;
+
+	/// The chunk size of the block allocator. Worlds with few objects waste less
+	/// memory with small chunks, see b2BlockAllocator.
+	int32 chunkSize;
+
+	/// The memory callbacks of the world, see b2Allocator. These are copied. Query
+	/// snapshots use them until their last reference is released, which may be after
+	/// the world is destroyed. Chain vertices use the callbacks of the block allocator,
+	/// which differ when it is shared. Use nullptr for b2Alloc and b2Free.
+	const b2Allocator* allocator;
+
+	/// A block allocator that is shared with other worlds, nullptr to use one per world.
+	/// The chunk size is then ignored. The worlds must be used on the same thread, or each
+	/// thread uses a cache of one root allocator. The allocator must outlive the worlds.
+	/// The world still embeds its own unused block allocator, which allocates nothing.
+	b2BlockAllocator* blockAllocator;
+
+	/// A stack allocator that is shared with other worlds, nullptr to use one per world.
+	/// The stack is empty between time steps, so worlds that are stepped one after another
+	/// on the same thread can share it. The allocator must outlive the worlds. The world
+	/// still embeds its own unused stack allocator, about 1 KB, which allocates nothing.
+	b2StackAllocator* stackAllocator;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -43,7 +153,14 @@ class b2World
 public:
 	/// Construct a world object.
 	/// @param gravity the world gravity vector.
-	b2World(const b2Vec2& gravity);
+	/// @param stackSize the initial size of the per step stack allocator. It grows as needed.
+	/// @param allocator the memory callbacks of this world, see b2Allocator. These are copied.
+	/// Pass nullptr to use b2Alloc and b2Free.
+	b2World(const b2Vec2& gravity, int32 stackSize = b2_stackSize, const b2Allocator* allocator = nullptr);
+
+	/// Construct a world object from a definition and reserve its capacities.
+	/// No reference to the definition is retained.
+	explicit b2World(const b2WorldDef* def);
 
 	/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 	~b2World();
@@ -57,10 +174,25 @@ public:
 	/// owned by you and must remain in scope. 
 	void SetContactFilter(b2ContactFilter* filter);
 
+	/// Register a contact filter function. This avoids the virtual call of b2ContactFilter
+	/// and replaces the group and mask test. Static body pairs and ignored body pairs are
+	/// still rejected. This replaces the contact filter. Pass nullptr to restore the default filter.
+	void SetContactFilterFunction(b2ContactFilterFcn* fcn, void* context);
+
+	/// Use a layer collision matrix instead of the group and mask test. Two fixtures collide
+	/// when bit b2Filter::layer of fixture B is set in row b2Filter::layer of fixture A, so
+	/// the matrix should be symmetric. The b2_maxCollisionLayers rows are copied. This replaces
+	/// the contact filter. Pass nullptr to restore the default filter.
+	void SetLayerCollisionMatrix(const uint32* matrix);
+
 	/// Register a contact event listener. The listener is owned by you and must
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Register a listener that is told when compaction or the contact arrays move
+	/// an object. The listener is owned by you and must remain in scope.
+	void SetRelocationListener(b2RelocationListener* listener);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DrawDebugData method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -77,6 +209,18 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyBody(b2Body* body);
 
+	/// Create a static body at the origin with a fixture for each shape of a shared geometry.
+	/// The fixtures use the shapes and the broad-phase tree of the geometry, they are not copied.
+	/// The world holds a reference to the geometry until the body is destroyed. A world can
+	/// attach one geometry at a time. The origin of such a world cannot be shifted.
+	/// @warning the body cannot be moved, deactivated or given another type and its fixtures
+	/// cannot be destroyed. Such calls assert and are otherwise ignored.
+	/// @warning This function is locked during callbacks.
+	b2Body* AttachStaticGeometry(b2StaticGeometry* geometry);
+
+	/// Get the attached static geometry or nullptr.
+	const b2StaticGeometry* GetStaticGeometry() const;
+
 	/// Create a joint to constrain bodies together. No reference to the definition
 	/// is retained. This may cause the connected bodies to cease colliding.
 	/// @warning This function is locked during callbacks.
@@ -86,6 +230,38 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Prevent collision between two bodies. This is reference counted, so each call must be
+	/// matched by a call to RestoreCollision. Joints with collideConnected set to false
+	/// use the same mechanism. The pairs of a destroyed body are removed automatically.
+	/// @warning This function is locked during callbacks.
+	void IgnoreCollision(b2Body* bodyA, b2Body* bodyB);
+
+	/// Remove a reference added by IgnoreCollision.
+	/// @warning This function is locked during callbacks.
+	void RestoreCollision(b2Body* bodyA, b2Body* bodyB);
+
+	/// Is collision between these bodies prevented by a joint or IgnoreCollision?
+	bool IsCollisionIgnored(const b2Body* bodyA, const b2Body* bodyB) const;
+
+	/// Create an AABB-only trigger volume. Triggers report when fixture proxies
+	/// begin or end overlapping the trigger AABB. They never create contacts
+	/// and are not reported by QueryAABB or RayCast.
+	/// @return the trigger id
+	/// @warning This function is locked during callbacks.
+	int32 CreateTrigger(const b2AABB& aabb, void* userData);
+
+	/// Destroy a trigger. Its overlaps are reported as end events by the next time step,
+	/// with the trigger id set to b2BroadPhase::e_nullProxy.
+	/// @warning This function is locked during callbacks.
+	void DestroyTrigger(int32 triggerId);
+
+	/// Move a trigger to a new AABB.
+	/// @warning This function is locked during callbacks.
+	void MoveTrigger(int32 triggerId, const b2AABB& aabb);
+
+	/// Get the user data of a trigger.
+	void* GetTriggerUserData(int32 triggerId) const;
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -95,6 +271,49 @@ public:
 				int32 velocityIterations,
 				int32 positionIterations);
 
+	/// Start a time step on a worker thread and return. Until Sync is called the world
+	/// belongs to the worker: only GetBodyState, the queue functions and Sync may be
+	/// called. Callbacks and listeners are called on the worker thread.
+	/// @warning This function is locked during callbacks.
+	void StepAsync(float32 timeStep, int32 velocityIterations, int32 positionIterations);
+
+	/// Wait for the asynchronous time step, publish its body state and apply the queued
+	/// commands. The commands are also applied if no step is running.
+	void Sync();
+
+	/// Is an asynchronous time step running? It is until Sync is called.
+	bool IsStepping() const;
+
+	/// Get the state of a body published by the last Sync. This can be read while the
+	/// next asynchronous step is running. Bodies created after the last asynchronous step
+	/// started are not included until it is synced.
+	/// @return nullptr if the body has no published state.
+	const b2BodyState* GetBodyState(b2BodyId id) const;
+
+	/// Queue a force at a world point. It is applied by the next Sync and acts in the
+	/// following time step. The queue functions must be called on the thread that calls
+	/// Sync. Commands on destroyed bodies are ignored.
+	void QueueForce(b2BodyId id, const b2Vec2& force, const b2Vec2& point);
+
+	/// Queue an impulse at a world point, applied by the next Sync.
+	void QueueLinearImpulse(b2BodyId id, const b2Vec2& impulse, const b2Vec2& point);
+
+	/// Queue a torque, applied by the next Sync.
+	void QueueTorque(b2BodyId id, float32 torque);
+
+	/// Queue a new position and angle, applied by the next Sync.
+	void QueueTransform(b2BodyId id, const b2Vec2& position, float32 angle);
+
+	/// Queue a new linear and angular velocity, applied by the next Sync.
+	void QueueVelocity(b2BodyId id, const b2Vec2& linearVelocity, float32 angularVelocity);
+
+	/// Queue the destruction of a body, applied by the next Sync.
+	void QueueDestroyBody(b2BodyId id);
+
+	/// Queue a function that is called by the next Sync. It may create and destroy
+	/// objects. The published body state is rewritten afterwards.
+	void QueueCommand(b2WorldCommandFcn* fcn, void* context);
+
 	/// Manually clear the force buffer on all bodies. By default, forces are cleared automatically
 	/// after each call to Step. The default behavior is modified by calling SetAutoClearForces.
 	/// The purpose of this function is to support sub-stepping. Sub-stepping is often used to maintain
@@ -121,6 +340,21 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Publish a query snapshot at the end of each time step. Other threads can query
+	/// the snapshot while the next time step runs. Publishing copies the broad-phase
+	/// tree and a transform and child shape per proxy. This is disabled by default.
+	/// @see b2QuerySnapshot
+	void SetQuerySnapshots(bool flag);
+
+	/// Get the flag that controls query snapshots.
+	bool GetQuerySnapshots() const;
+
+	/// Get the snapshot published by the last time step, nullptr if there is none. The
+	/// world holds a reference until a later time step replaces it, so Retain the snapshot
+	/// before giving it to other threads and Release it when they are done. Call this
+	/// between time steps, for example after Sync.
+	b2QuerySnapshot* GetQuerySnapshot();
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A nullptr body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -137,7 +371,11 @@ public:
 	/// the next contact in the world list. A nullptr contact indicates the end of the list.
 	/// @return the head of the world contact list.
 	/// @warning contacts are created and destroyed in the middle of a time step.
-	/// Use b2ContactListener to avoid missing contacts.
+	/// Use b2ContactListener to avoid missing contacts. Contacts are stored in
+	/// arrays by shape types and may move during a time step, use b2ContactId or
+	/// b2RelocationListener to refer to a contact across time steps.
+	/// @note dynamic body pairs that only overlap in the broad-phase do not have a
+	/// contact until their shapes touch.
 	b2Contact* GetContactList();
 	const b2Contact* GetContactList() const;
 
@@ -169,6 +407,96 @@ public:
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
+	/// Get a body from its handle.
+	/// @return nullptr if the body was destroyed.
+	b2Body* GetBody(b2BodyId id);
+	const b2Body* GetBody(b2BodyId id) const;
+
+	/// Get a fixture from its handle.
+	/// @return nullptr if the fixture was destroyed.
+	b2Fixture* GetFixture(b2FixtureId id);
+	const b2Fixture* GetFixture(b2FixtureId id) const;
+
+	/// Get a joint from its handle.
+	/// @return nullptr if the joint was destroyed.
+	b2Joint* GetJoint(b2JointId id);
+	const b2Joint* GetJoint(b2JointId id) const;
+
+	/// Get a contact from its handle. Contacts are destroyed when their fixture AABBs
+	/// stop overlapping, so contact handles are short lived.
+	/// @return nullptr if the contact was destroyed.
+	b2Contact* GetContact(b2ContactId id);
+	const b2Contact* GetContact(b2ContactId id) const;
+
+	/// Get the number of broad-phase pairs that have not been promoted to contacts.
+	int32 GetPairCount() const;
+
+	/// Get the joints that broke during the last time step. Broken joints are destroyed
+	/// at the end of the time step. A gear joint breaks with its revolute or prismatic
+	/// joints. These are valid until the next time step.
+	/// @see b2JointDef::breakForce
+	const b2JointBreakEvent* GetJointBreakEvents() const;
+	int32 GetJointBreakEventCount() const;
+
+	/// Get the sensor begin events of the last time step for all sensors.
+	/// These are valid until the next time step or until a fixture is destroyed.
+	const b2SensorEvent* GetSensorBeginEvents() const;
+	int32 GetSensorBeginEventCount() const;
+
+	/// Get the sensor end events of the last time step for all sensors. Overlaps that were
+	/// removed between time steps, for example by destroying a fixture, are reported here
+	/// with the next time step. They are not in the b2Fixture::GetSensorEndEvents ranges.
+	const b2SensorEvent* GetSensorEndEvents() const;
+	int32 GetSensorEndEventCount() const;
+
+	/// Get the contact begin touch events of the last time step. Only contacts of fixtures with
+	/// contact events enabled are reported. These are valid until the next time step or until
+	/// a fixture is destroyed.
+	const b2ContactBeginTouchEvent* GetContactBeginEvents() const;
+	int32 GetContactBeginEventCount() const;
+
+	/// Get the contact end touch events of the last time step. Each begin touch event gets
+	/// one end touch event. Contacts destroyed between time steps, for example by destroying
+	/// a fixture, are reported here with the next time step.
+	const b2ContactEndTouchEvent* GetContactEndEvents() const;
+	int32 GetContactEndEventCount() const;
+
+	/// Get the contact hit events of the last time step. Only contacts of fixtures with
+	/// hit events enabled are reported.
+	const b2ContactHitEvent* GetContactHitEvents() const;
+	int32 GetContactHitEventCount() const;
+
+	/// Get the contact impulse events of the last time step. Only contacts of fixtures with
+	/// impulse events enabled are reported. A contact may be reported by the regular and
+	/// the TOI solvers in the same time step.
+	const b2ContactImpulseEvent* GetContactImpulseEvents() const;
+	int32 GetContactImpulseEventCount() const;
+
+	/// Set the minimum approach speed for hit events, usually in meters per second.
+	void SetHitEventThreshold(float32 threshold);
+
+	/// Get the minimum approach speed for hit events.
+	float32 GetHitEventThreshold() const;
+
+	/// Set the minimum normal impulse for impulse events, usually in N*s.
+	void SetImpulseEventThreshold(float32 threshold);
+
+	/// Get the minimum normal impulse for impulse events.
+	float32 GetImpulseEventThreshold() const;
+
+	/// Get the trigger begin events of the last time step. The event user data is
+	/// the b2FixtureProxy of the visitor. These are valid until the next time step.
+	/// The user data is set to nullptr when the fixture is destroyed.
+	const b2TriggerEvent* GetTriggerBeginEvents() const;
+	int32 GetTriggerBeginEventCount() const;
+
+	/// Get the trigger end events of the last time step. Overlaps removed between time
+	/// steps, by destroying or deactivating a fixture or destroying a trigger, are reported
+	/// by the next time step. The id of a removed proxy is b2BroadPhase::e_nullProxy and
+	/// the user data of a destroyed fixture is nullptr.
+	const b2TriggerEvent* GetTriggerEndEvents() const;
+	int32 GetTriggerEndEventCount() const;
+
 	/// Get the height of the dynamic tree.
 	int32 GetTreeHeight() const;
 
@@ -199,12 +527,65 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Enable incremental compaction. Each time step moves up to this many bodies,
+	/// together with their fixtures, to new memory so that the objects of an island
+	/// end up next to each other. A sweep over the world takes several
+	/// time steps and a large island may be split across steps. Handles are preserved,
+	/// pointers are reported to the relocation listener. Zero disables compaction,
+	/// this is the default.
+	void SetCompactionBudget(int32 bodyCount);
+
+	/// Get the number of bodies that compaction may move per time step.
+	int32 GetCompactionBudget() const;
+
+	/// Reserve memory for this many bodies. This includes the body blocks, the body
+	/// array, the body state arrays and the handles.
+	void ReserveBodies(int32 bodyCount);
+
+	/// Reserve memory for this many fixtures. This includes the fixture blocks, a proxy
+	/// for each fixture and the handles. Shapes are not included, their size depends
+	/// on the type.
+	void ReserveFixtures(int32 fixtureCount);
+
+	/// Reserve the handles of this many joints. Joint blocks are not included, their
+	/// size depends on the type.
+	void ReserveJoints(int32 jointCount);
+
+	/// Reserve memory for this many contacts. This includes the pair array, the event
+	/// buffers and the handles. The contacts are not included, they are stored by
+	/// shape types.
+	void ReserveContacts(int32 contactCount);
+
+	/// Reserve the contact array of a pair of shape types for this many contacts.
+	/// This moves the contacts of these types, see b2RelocationListener.
+	void ReserveContacts(b2Shape::Type typeA, b2Shape::Type typeB, int32 contactCount);
+
+	/// Reserve the broad-phase tree and buffers for this many proxies.
+	void ReserveProxies(int32 proxyCount);
+
+	/// Reserve this many bytes in the stack allocator.
+	void ReserveStack(int32 size);
+
+	/// Assert when a time step allocates memory. Together with the reserve functions this
+	/// verifies that a world in a steady state does not use the heap. Allocations are
+	/// counted with b2GetAllocationCount, this includes the allocations of callbacks.
+	/// The count of the last time step is in b2Profile::allocations.
+	void SetAllocationCheck(bool flag);
+
+	/// Get the flag that controls the allocation check.
+	bool GetAllocationCheck() const;
+
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the memory used by this world. This walks all objects, so it
+	/// should not be called every time step. The chunk and stack values
+	/// include other worlds that share the allocators, see b2MemoryStats.
+	void GetMemoryStats(b2MemoryStats* stats) const;
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
@@ -216,22 +597,51 @@ private:
 	{
 		e_newFixture	= 0x0001,
 		e_locked		= 0x0002,
-		e_clearForces	= 0x0004
+		e_clearForces	= 0x0004,
+		e_checkAllocations	= 0x0008,
+		e_querySnapshots	= 0x0010
 	};
 
 	friend class b2Body;
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2StepWorker;
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	void PushJointBreakEvent(b2Joint* joint, float32 inv_dt);
+	void BreakGearJoints(float32 inv_dt);
+
+	void FlagContactsForFiltering(b2Body* bodyA, b2Body* bodyB);
+
+	void Initialize(const b2WorldDef* def);
+
+	void ResizeBodies(int32 capacity);
+
+	void Compact();
+	void ReserveCompactionStack(int32 count);
+	b2Body* RelocateBody(b2Body* b, b2GearJoint** gearJoints, int32 gearJointCount);
+	b2Fixture* RelocateFixture(b2Fixture* f);
+
+	void PublishQuerySnapshot();
+
+	b2WorldCommand* PushCommand(int32 type, b2BodyId id);
+	void WriteBodyStates(int32 buffer);
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
-	b2BlockAllocator m_blockAllocator;
-	b2StackAllocator m_stackAllocator;
+	// The memory callbacks of the world arrays, handle tables and snapshots.
+	b2Allocator m_allocator;
+
+	b2BlockAllocator m_ownBlockAllocator;
+	b2StackAllocator m_ownStackAllocator;
+
+	// These point to the own allocators unless shared allocators were given.
+	b2BlockAllocator* m_blockAllocator;
+	b2StackAllocator* m_stackAllocator;
 
 	int32 m_flags;
 
@@ -240,15 +650,42 @@ private:
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
 
+	// Body pairs that should not collide.
+	b2BodyPairSet m_ignorePairs;
+
+	// Handle tables. The contact handles live in the contact manager.
+	b2HandleTable m_bodyIds;
+	b2HandleTable m_fixtureIds;
+	b2HandleTable m_jointIds;
+
+	// Dense array of the bodies, see b2Body::m_worldIndex. The simulation
+	// loops scan this instead of the body list, except the island seed loop,
+	// whose order changes the results.
+	b2Body** m_bodies;
 	int32 m_bodyCount;
+	int32 m_bodyCapacity;
+
+	// The simulation state of the bodies, parallel to m_bodies. The arrays
+	// share one allocation that starts at the transforms.
+	b2BodyArrays m_bodyArrays;
+
 	int32 m_jointCount;
 
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
 	b2DestructionListener* m_destructionListener;
+	b2RelocationListener* m_relocationListener;
 	b2Draw* g_debugDraw;
 
+	// Compaction resumes at this index of the body array, after the bodies
+	// left on the stack of an island that the budget cut short.
+	int32 m_compactionBudget;
+	int32 m_compactionCursor;
+	b2BodyId* m_compactionStack;
+	int32 m_compactionStackCount;
+	int32 m_compactionStackCapacity;
+
 	// This is used to compute the time step ratio to
 	// support a variable time step.
 	float32 m_inv_dt0;
@@ -261,6 +698,33 @@ private:
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	b2JointBreakEvent* m_jointBreakEvents;
+	int32 m_jointBreakEventCount;
+	int32 m_jointBreakEventCapacity;
+
+	// The attached geometry, its body and the broad-phase user data of its proxies.
+	b2StaticGeometry* m_staticGeometry;
+	b2Body* m_staticGeometryBody;
+	void** m_staticUserData;
+
+	// Asynchronous stepping. The worker writes the body states of buffer
+	// m_stateIndex ^ 1 while the caller reads buffer m_stateIndex.
+	b2StepWorker* m_worker;
+	bool m_stepping;
+	b2BodyState* m_bodyStates[2];
+	int32 m_bodyStateCapacity[2];
+	int32 m_stateIndex;
+
+	b2WorldCommand* m_commands;
+	int32 m_commandCount;
+	int32 m_commandCapacity;
+
+	// The published snapshot and the previous one, which is rebuilt once
+	// the world holds its only reference.
+	b2QuerySnapshot* m_querySnapshot;
+	b2QuerySnapshot* m_spareSnapshot;
+	uint32 m_snapshotVersion;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -308,6 +772,210 @@ inline int32 b2World::GetContactCount() const
 	return m_contactManager.m_contactCount;
 }
 
+inline const b2StaticGeometry* b2World::GetStaticGeometry() const
+{
+	return m_staticGeometry;
+}
+
+inline bool b2World::GetQuerySnapshots() const
+{
+	return (m_flags & e_querySnapshots) == e_querySnapshots;
+}
+
+inline b2QuerySnapshot* b2World::GetQuerySnapshot()
+{
+	return m_querySnapshot;
+}
+
+inline bool b2World::IsStepping() const
+{
+	return m_stepping;
+}
+
+inline const b2BodyState* b2World::GetBodyState(b2BodyId id) const
+{
+	int32 index = int32(id >> b2HandleTable::e_generationBits);
+	if (index >= m_bodyStateCapacity[m_stateIndex])
+	{
+		return nullptr;
+	}
+
+	// Slots of destroyed bodies have a stale or null id.
+	const b2BodyState* state = m_bodyStates[m_stateIndex] + index;
+	return state->id == id && id != b2_nullId ? state : nullptr;
+}
+
+inline int32 b2World::GetCompactionBudget() const
+{
+	return m_compactionBudget;
+}
+
+inline bool b2World::GetAllocationCheck() const
+{
+	return (m_flags & e_checkAllocations) == e_checkAllocations;
+}
+
+inline int32 b2World::GetPairCount() const
+{
+	return m_contactManager.m_pairCount;
+}
+
+inline b2Body* b2World::GetBody(b2BodyId id)
+{
+	return (b2Body*)m_bodyIds.Get(id);
+}
+
+inline const b2Body* b2World::GetBody(b2BodyId id) const
+{
+	return (const b2Body*)m_bodyIds.Get(id);
+}
+
+inline b2Fixture* b2World::GetFixture(b2FixtureId id)
+{
+	return (b2Fixture*)m_fixtureIds.Get(id);
+}
+
+inline const b2Fixture* b2World::GetFixture(b2FixtureId id) const
+{
+	return (const b2Fixture*)m_fixtureIds.Get(id);
+}
+
+inline b2Joint* b2World::GetJoint(b2JointId id)
+{
+	return (b2Joint*)m_jointIds.Get(id);
+}
+
+inline const b2Joint* b2World::GetJoint(b2JointId id) const
+{
+	return (const b2Joint*)m_jointIds.Get(id);
+}
+
+inline b2Contact* b2World::GetContact(b2ContactId id)
+{
+	return (b2Contact*)m_contactManager.m_contactIds.Get(id);
+}
+
+inline const b2Contact* b2World::GetContact(b2ContactId id) const
+{
+	return (const b2Contact*)m_contactManager.m_contactIds.Get(id);
+}
+
+inline const b2JointBreakEvent* b2World::GetJointBreakEvents() const
+{
+	return m_jointBreakEvents;
+}
+
+inline int32 b2World::GetJointBreakEventCount() const
+{
+	return m_jointBreakEventCount;
+}
+
+inline const b2SensorEvent* b2World::GetSensorBeginEvents() const
+{
+	return m_contactManager.m_sensorManager.m_beginEvents;
+}
+
+inline int32 b2World::GetSensorBeginEventCount() const
+{
+	return m_contactManager.m_sensorManager.m_beginCount;
+}
+
+inline const b2SensorEvent* b2World::GetSensorEndEvents() const
+{
+	return m_contactManager.m_sensorManager.m_endEvents;
+}
+
+inline int32 b2World::GetSensorEndEventCount() const
+{
+	return m_contactManager.m_sensorManager.m_endCount;
+}
+
+inline const b2ContactBeginTouchEvent* b2World::GetContactBeginEvents() const
+{
+	return m_contactManager.m_beginEvents;
+}
+
+inline int32 b2World::GetContactBeginEventCount() const
+{
+	return m_contactManager.m_beginEventCount;
+}
+
+inline const b2ContactEndTouchEvent* b2World::GetContactEndEvents() const
+{
+	return m_contactManager.m_endEvents;
+}
+
+inline int32 b2World::GetContactEndEventCount() const
+{
+	return m_contactManager.m_endEventCount;
+}
+
+inline const b2ContactHitEvent* b2World::GetContactHitEvents() const
+{
+	return m_contactManager.m_hitEvents;
+}
+
+inline int32 b2World::GetContactHitEventCount() const
+{
+	return m_contactManager.m_hitEventCount;
+}
+
+inline const b2ContactImpulseEvent* b2World::GetContactImpulseEvents() const
+{
+	return m_contactManager.m_impulseEvents;
+}
+
+inline int32 b2World::GetContactImpulseEventCount() const
+{
+	return m_contactManager.m_impulseEventCount;
+}
+
+inline void b2World::SetHitEventThreshold(float32 threshold)
+{
+	m_contactManager.m_hitEventThreshold = threshold;
+}
+
+inline float32 b2World::GetHitEventThreshold() const
+{
+	return m_contactManager.m_hitEventThreshold;
+}
+
+inline void b2World::SetImpulseEventThreshold(float32 threshold)
+{
+	m_contactManager.m_impulseEventThreshold = threshold;
+}
+
+inline float32 b2World::GetImpulseEventThreshold() const
+{
+	return m_contactManager.m_impulseEventThreshold;
+}
+
+inline void* b2World::GetTriggerUserData(int32 triggerId) const
+{
+	b2Assert(m_contactManager.m_broadPhase.IsTrigger(triggerId));
+	return m_contactManager.m_broadPhase.GetUserData(triggerId);
+}
+
+inline const b2TriggerEvent* b2World::GetTriggerBeginEvents() const
+{
+	return m_contactManager.m_broadPhase.GetTriggerBeginEvents();
+}
+
+inline int32 b2World::GetTriggerBeginEventCount() const
+{
+	return m_contactManager.m_broadPhase.GetTriggerBeginEventCount();
+}
+
+inline const b2TriggerEvent* b2World::GetTriggerEndEvents() const
+{
+	return m_contactManager.m_broadPhase.GetTriggerEndEvents();
+}
+
+inline int32 b2World::GetTriggerEndEventCount() const
+{
+	return m_contactManager.m_broadPhase.GetTriggerEndEventCount();
+}
+
 inline void b2World::SetGravity(const b2Vec2& gravity)
 {
 	m_gravity = gravity;
@@ -27,6 +27,7 @@ class b2Fixture;
 class b2Body;
 class b2Joint;
 class b2Contact;
+class b2World;
 struct b2ContactResult;
 struct b2Manifold;
 
@@ -47,6 +48,42 @@ public:
 	virtual void SayGoodbye(b2Fixture* fixture) = 0;
 };
 
+/// World compaction moves bodies and fixtures to new memory, see
+/// b2World::SetCompactionBudget. Contacts move during a time step when their
+/// contact array grows or another contact of the array is destroyed. Implement
+/// this listener if you keep pointers to these objects. Handles stay valid across
+/// moves. The old object must not be dereferenced.
+class b2RelocationListener
+{
+public:
+	virtual ~b2RelocationListener() {}
+
+	/// Called after a body was moved.
+	virtual void BodyMoved(b2Body* oldBody, b2Body* newBody)
+	{
+		B2_NOT_USED(oldBody);
+		B2_NOT_USED(newBody);
+	}
+
+	/// Called after a fixture was moved.
+	virtual void FixtureMoved(b2Fixture* oldFixture, b2Fixture* newFixture)
+	{
+		B2_NOT_USED(oldFixture);
+		B2_NOT_USED(newFixture);
+	}
+
+	/// Called after a contact was moved.
+	virtual void ContactMoved(b2Contact* oldContact, b2Contact* newContact)
+	{
+		B2_NOT_USED(oldContact);
+		B2_NOT_USED(newContact);
+	}
+};
+
+/// A non-virtual alternative to b2ContactFilter, see b2World::SetContactFilterFunction.
+/// Return true if contact calculations should be performed between these two fixtures.
+typedef bool b2ContactFilterFcn(b2Fixture* fixtureA, b2Fixture* fixtureB, void* context);
+
 /// Implement this class to provide collision filtering. In other words, you can implement
 /// this class if you want finer control over contact creation.
 class b2ContactFilter
@@ -152,4 +189,8 @@ public:
 									const b2Vec2& normal, float32 fraction) = 0;
 };
 
+/// A function queued with b2World::QueueCommand. It runs at the next sync point,
+/// when the world is not locked.
+typedef void b2WorldCommandFcn(b2World* world, void* context);
+
 #endif
@@ -55,6 +55,8 @@ Test::Test()
 
 	memset(&m_maxProfile, 0, sizeof(b2Profile));
 	memset(&m_totalProfile, 0, sizeof(b2Profile));
+
+	m_memoryAge = 0;
 }
 
 Test::~Test()
@@ -310,8 +312,9 @@ void Test::Step(Settings* settings)
 	{
 		int32 bodyCount = m_world->GetBodyCount();
 		int32 contactCount = m_world->GetContactCount();
+		int32 pairCount = m_world->GetPairCount();
 		int32 jointCount = m_world->GetJointCount();
-		g_debugDraw.DrawString(5, m_textLine, "bodies/contacts/joints = %d/%d/%d", bodyCount, contactCount, jointCount);
+		g_debugDraw.DrawString(5, m_textLine, "bodies/contacts/pairs/joints = %d/%d/%d/%d", bodyCount, contactCount, pairCount, jointCount);
 		m_textLine += DRAW_STRING_NEW_LINE;
 
 		int32 proxyCount = m_world->GetProxyCount();
@@ -322,6 +325,34 @@ void Test::Step(Settings* settings)
 		m_textLine += DRAW_STRING_NEW_LINE;
 	}
 
+	if (settings->drawMemory)
+	{
+		if (m_memoryAge == 0)
+		{
+			m_world->GetMemoryStats(&m_memoryStats);
+		}
+		m_memoryAge = (m_memoryAge + 1) % 30;
+
+		const b2MemoryStats& memory = m_memoryStats;
+		int32 worldBytes = memory.bodyBytes + memory.fixtureBytes + memory.shapeBytes + memory.contactBytes + memory.jointBytes;
+		g_debugDraw.DrawString(5, m_textLine, "world: objects/tree/buffers (KB) = %d/%d/%d",
+			worldBytes / 1024, memory.treeBytes / 1024, memory.broadPhaseBytes / 1024);
+		m_textLine += DRAW_STRING_NEW_LINE;
+
+		int32 chunkUsed = memory.chunkBytes - memory.chunkFreeBytes;
+		g_debugDraw.DrawString(5, m_textLine, "%s: chunks/used/free (KB) = %d/%d/%d",
+			memory.sharedBlocks ? "shared blocks" : "blocks", memory.chunkCount, chunkUsed / 1024, memory.chunkFreeBytes / 1024);
+		m_textLine += DRAW_STRING_NEW_LINE;
+
+		g_debugDraw.DrawString(5, m_textLine, "%s: capacity/max (KB) = %d/%d",
+			memory.sharedStack ? "shared stack" : "stack", memory.stackBytes / 1024, memory.stackMaxBytes / 1024);
+		m_textLine += DRAW_STRING_NEW_LINE;
+	}
+	else
+	{
+		m_memoryAge = 0;
+	}
+
 	// Track maximum profile times
 	{
 		const b2Profile& p = m_world->GetProfile();
@@ -333,6 +364,7 @@ void Test::Step(Settings* settings)
 		m_maxProfile.solvePosition = b2Max(m_maxProfile.solvePosition, p.solvePosition);
 		m_maxProfile.solveTOI = b2Max(m_maxProfile.solveTOI, p.solveTOI);
 		m_maxProfile.broadphase = b2Max(m_maxProfile.broadphase, p.broadphase);
+		m_maxProfile.sensors = b2Max(m_maxProfile.sensors, p.sensors);
 
 		m_totalProfile.step += p.step;
 		m_totalProfile.collide += p.collide;
@@ -342,6 +374,7 @@ void Test::Step(Settings* settings)
 		m_totalProfile.solvePosition += p.solvePosition;
 		m_totalProfile.solveTOI += p.solveTOI;
 		m_totalProfile.broadphase += p.broadphase;
+		m_totalProfile.sensors += p.sensors;
 	}
 
 	if (settings->drawProfile)
@@ -361,6 +394,7 @@ void Test::Step(Settings* settings)
 			aveProfile.solvePosition = scale * m_totalProfile.solvePosition;
 			aveProfile.solveTOI = scale * m_totalProfile.solveTOI;
 			aveProfile.broadphase = scale * m_totalProfile.broadphase;
+			aveProfile.sensors = scale * m_totalProfile.sensors;
 		}
 
 		g_debugDraw.DrawString(5, m_textLine, "step [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.step, aveProfile.step, m_maxProfile.step);
@@ -379,6 +413,10 @@ void Test::Step(Settings* settings)
 		m_textLine += DRAW_STRING_NEW_LINE;
 		g_debugDraw.DrawString(5, m_textLine, "broad-phase [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.broadphase, aveProfile.broadphase, m_maxProfile.broadphase);
 		m_textLine += DRAW_STRING_NEW_LINE;
+		g_debugDraw.DrawString(5, m_textLine, "sensors [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.sensors, aveProfile.sensors, m_maxProfile.sensors);
+		m_textLine += DRAW_STRING_NEW_LINE;
+		g_debugDraw.DrawString(5, m_textLine, "stack allocation (max) = %d bytes, heap allocations = %d", p.stackAllocation, p.allocations);
+		m_textLine += DRAW_STRING_NEW_LINE;
 	}
 
 	if (m_mouseJoint)
@@ -71,6 +71,7 @@ struct Settings
 		drawCOMs = false;
 		drawStats = false;
 		drawProfile = false;
+		drawMemory = false;
 		enableWarmStarting = true;
 		enableContinuous = true;
 		enableSubStepping = false;
@@ -92,6 +93,7 @@ struct Settings
 	bool drawCOMs;
 	bool drawStats;
 	bool drawProfile;
+	bool drawMemory;
 	bool enableWarmStarting;
 	bool enableContinuous;
 	bool enableSubStepping;
@@ -190,6 +192,10 @@ protected:
 
 	b2Profile m_maxProfile;
 	b2Profile m_totalProfile;
+
+	// GetMemoryStats walks the world, so it is refreshed periodically.
+	b2MemoryStats m_memoryStats;
+	int32 m_memoryAge;
 };
 
 #endif
@@ -78,11 +78,6 @@ public:
 		}
 #endif
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float32 b2_toiTime, b2_toiMaxTime;
-
 		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
 		b2_toiCalls = 0; b2_toiIters = 0;
 		b2_toiRootIters = 0; b2_toiMaxRootIters = 0;
@@ -91,11 +86,6 @@ public:
 
 	void Launch()
 	{
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float32 b2_toiTime, b2_toiMaxTime;
-
 		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
 		b2_toiCalls = 0; b2_toiIters = 0;
 		b2_toiRootIters = 0; b2_toiMaxRootIters = 0;
@@ -111,8 +101,6 @@ public:
 	{
 		Test::Step(settings);
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-
 		if (b2_gjkCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "gjk calls = %d, ave gjk iters = %3.1f, max gjk iters = %d",
@@ -120,10 +108,6 @@ public:
 			m_textLine += DRAW_STRING_NEW_LINE;
 		}
 
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float32 b2_toiTime, b2_toiMaxTime;
-
 		if (b2_toiCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "toi calls = %d, ave [max] toi iters = %3.1f [%d]",
@@ -50,10 +50,13 @@ public:
 
 			b2PolygonShape shape;
 			shape.SetAsBox(3.0f, 0.5f);
-			m_platform = body->CreateFixture(&shape, 0.0f);
 
-			m_bottom = 10.0f - 0.5f;
-			m_top = 10.0f + 0.5f;
+			// The platform is solid from above only.
+			b2FixtureDef fd;
+			fd.shape = &shape;
+			fd.oneSided = true;
+			fd.oneSidedNormal.Set(0.0f, 1.0f);
+			m_platform = body->CreateFixture(&fd);
 		}
 
 		// Actor
@@ -74,39 +77,6 @@ public:
 		}
 	}
 
-	void PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
-	{
-		Test::PreSolve(contact, oldManifold);
-
-		b2Fixture* fixtureA = contact->GetFixtureA();
-		b2Fixture* fixtureB = contact->GetFixtureB();
-
-		if (fixtureA != m_platform && fixtureA != m_character)
-		{
-			return;
-		}
-
-		if (fixtureB != m_platform && fixtureB != m_character)
-		{
-			return;
-		}
-
-#if 1
-		b2Vec2 position = m_character->GetBody()->GetPosition();
-
-		if (position.y < m_top + m_radius - 3.0f * b2_linearSlop)
-		{
-			contact->SetEnabled(false);
-		}
-#else
-        b2Vec2 v = m_character->GetBody()->GetLinearVelocity();
-        if (v.y > 0.0f)
-		{
-            contact->SetEnabled(false);
-        }
-#endif
-	}
-
 	void Step(Settings* settings)
 	{
 		Test::Step(settings);
@@ -123,7 +93,7 @@ public:
 		return new OneSidedPlatform;
 	}
 
-	float32 m_radius, m_top, m_bottom;
+	float32 m_radius;
 	State m_state;
 	b2Fixture* m_platform;
 	b2Fixture* m_character;
@@ -81,65 +81,34 @@ public:
 		}
 	}
 
-	// Implement contact listener.
-	void BeginContact(b2Contact* contact)
+	void Step(Settings* settings)
 	{
-		b2Fixture* fixtureA = contact->GetFixtureA();
-		b2Fixture* fixtureB = contact->GetFixtureB();
-
-		if (fixtureA == m_sensor)
-		{
-			void* userData = fixtureB->GetBody()->GetUserData();
-			if (userData)
-			{
-				bool* touching = (bool*)userData;
-				*touching = true;
-			}
-		}
+		Test::Step(settings);
 
-		if (fixtureB == m_sensor)
+		// Process the sensor events of this step.
+		const b2SensorEvent* beginEvents = m_sensor->GetSensorBeginEvents();
+		for (int32 i = 0; i < m_sensor->GetSensorBeginEventCount(); ++i)
 		{
-			void* userData = fixtureA->GetBody()->GetUserData();
+			void* userData = beginEvents[i].visitor->GetBody()->GetUserData();
 			if (userData)
 			{
 				bool* touching = (bool*)userData;
 				*touching = true;
 			}
 		}
-	}
-
-	// Implement contact listener.
-	void EndContact(b2Contact* contact)
-	{
-		b2Fixture* fixtureA = contact->GetFixtureA();
-		b2Fixture* fixtureB = contact->GetFixtureB();
-
-		if (fixtureA == m_sensor)
-		{
-			void* userData = fixtureB->GetBody()->GetUserData();
-			if (userData)
-			{
-				bool* touching = (bool*)userData;
-				*touching = false;
-			}
-		}
 
-		if (fixtureB == m_sensor)
+		const b2SensorEvent* endEvents = m_sensor->GetSensorEndEvents();
+		for (int32 i = 0; i < m_sensor->GetSensorEndEventCount(); ++i)
 		{
-			void* userData = fixtureA->GetBody()->GetUserData();
+			void* userData = endEvents[i].visitor->GetBody()->GetUserData();
 			if (userData)
 			{
 				bool* touching = (bool*)userData;
 				*touching = false;
 			}
 		}
-	}
-
-	void Step(Settings* settings)
-	{
-		Test::Step(settings);
 
-		// Traverse the contact results. Apply a force on shapes
+		// Traverse the sensor results. Apply a force on shapes
 		// that overlap the sensor.
 		for (int32 i = 0; i < e_count; ++i)
 		{
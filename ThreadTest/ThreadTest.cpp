@@ -0,0 +1,172 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D/Box2D.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// This program steps several worlds at once, one per thread, and checks that the
+// collision counters of each world only see the work of that world. Build it with
+// -fsanitize=thread (the premake project does this for gcc and clang) to also find
+// data races in the library.
+
+// The totals of the b2Profile counters over all time steps of a world.
+struct Totals
+{
+	int32 gjkCalls;
+	int32 gjkIters;
+	int32 gjkMaxIters;
+	int32 toiCalls;
+	int32 toiIters;
+	int32 toiMaxIters;
+	int32 toiRootIters;
+	int32 toiMaxRootIters;
+	float32 x;
+	float32 y;
+	bool counterMismatch;
+};
+
+// A pile of boxes hit by fast circles, so that every time step runs GJK and TOI.
+// The seed moves the bullets, so each world does a different amount of work.
+static void Simulate(int32 seed, int32 stepCount, Totals* totals)
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bodyDef;
+	b2Body* ground = world.CreateBody(&bodyDef);
+
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	bodyDef.type = b2_dynamicBody;
+	for (int32 i = 0; i < 10; ++i)
+	{
+		for (int32 j = i; j < 10; ++j)
+		{
+			bodyDef.position.Set(-5.0f + 0.5f * i + 1.0f * (j - i), 0.5f + 1.0f * i);
+			world.CreateBody(&bodyDef)->CreateFixture(&box, 5.0f);
+		}
+	}
+
+	b2CircleShape circle;
+	circle.m_radius = 0.25f;
+
+	bodyDef.bullet = true;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		bodyDef.position.Set(-30.0f - 2.0f * i, 2.0f + 0.5f * (seed % 8) + i);
+		bodyDef.linearVelocity.Set(200.0f + 10.0f * seed, 0.0f);
+		world.CreateBody(&bodyDef)->CreateFixture(&circle, 1.0f);
+	}
+
+	Totals t = {};
+
+	// The counters are thread local, so this thread sees only the work of its world.
+	int32 gjkCalls = b2_gjkCalls;
+	int32 toiCalls = b2_toiCalls;
+
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+
+		const b2Profile& p = world.GetProfile();
+		t.gjkCalls += p.gjkCalls;
+		t.gjkIters += p.gjkIters;
+		t.gjkMaxIters = b2Max(t.gjkMaxIters, p.gjkMaxIters);
+		t.toiCalls += p.toiCalls;
+		t.toiIters += p.toiIters;
+		t.toiMaxIters = b2Max(t.toiMaxIters, p.toiMaxIters);
+		t.toiRootIters += p.toiRootIters;
+		t.toiMaxRootIters = b2Max(t.toiMaxRootIters, p.toiMaxRootIters);
+	}
+
+	t.counterMismatch = b2_gjkCalls - gjkCalls != t.gjkCalls || b2_toiCalls - toiCalls != t.toiCalls;
+
+	for (b2Body* b = world.GetBodyList(); b; b = b->GetNext())
+	{
+		t.x += b->GetPosition().x;
+		t.y += b->GetPosition().y;
+	}
+
+	*totals = t;
+}
+
+static bool Equal(const Totals& a, const Totals& b)
+{
+	return a.gjkCalls == b.gjkCalls && a.gjkIters == b.gjkIters && a.gjkMaxIters == b.gjkMaxIters &&
+		a.toiCalls == b.toiCalls && a.toiIters == b.toiIters && a.toiMaxIters == b.toiMaxIters &&
+		a.toiRootIters == b.toiRootIters && a.toiMaxRootIters == b.toiMaxRootIters &&
+		a.x == b.x && a.y == b.y;
+}
+
+// Usage: ThreadTest [threadCount] [stepCount]
+int main(int argc, char** argv)
+{
+	int32 threadCount = argc > 1 ? atoi(argv[1]) : 8;
+	int32 stepCount = argc > 2 ? atoi(argv[2]) : 300;
+	if (threadCount < 1 || stepCount < 1)
+	{
+		printf("usage: ThreadTest [threadCount] [stepCount]\n");
+		return 1;
+	}
+
+	// Run each world alone first. The simulation is deterministic, so these are
+	// the totals the concurrent runs must reproduce.
+	std::vector<Totals> expected(threadCount);
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		Simulate(i, stepCount, &expected[i]);
+	}
+
+	std::vector<Totals> results(threadCount);
+	std::vector<std::thread> threads;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		threads.emplace_back(Simulate, i, stepCount, &results[i]);
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	int32 failures = 0;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		const Totals& t = results[i];
+		bool ok = t.counterMismatch == false && expected[i].counterMismatch == false && Equal(t, expected[i]);
+		printf("world %d: gjk %d calls %d iters (max %d), toi %d calls %d iters (max %d) %d root iters (max %d) %s\n",
+			i, t.gjkCalls, t.gjkIters, t.gjkMaxIters, t.toiCalls, t.toiIters, t.toiMaxIters,
+			t.toiRootIters, t.toiMaxRootIters, ok ? "ok" : "MISMATCH");
+
+		if (ok == false || t.gjkCalls == 0 || t.toiCalls == 0)
+		{
+			++failures;
+		}
+	}
+
+	printf("%s\n", failures == 0 ? "passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
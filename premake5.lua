@@ -37,6 +37,22 @@ project 'HelloWorld'
 	files { 'HelloWorld/HelloWorld.cpp' }
 	includedirs { '.' }
 	links { 'Box2D' }
+	filter { 'system:linux' }
+		links { 'pthread' }
+	filter {}
+
+-- Steps worlds on several threads. The library sources are compiled into this
+-- project so the thread sanitizer instruments them too.
+project 'ThreadTest'
+	kind 'ConsoleApp'
+	files { 'ThreadTest/ThreadTest.cpp', 'Box2D/**' }
+	includedirs { '.' }
+	filter { 'system:linux or macosx' }
+		buildoptions { '-fsanitize=thread' }
+		linkoptions { '-fsanitize=thread' }
+	filter { 'system:linux' }
+		links { 'pthread' }
+	filter {}
 
 project 'Testbed'
 	kind 'ConsoleApp'